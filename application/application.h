@@ -2,6 +2,8 @@
 
 #include "base.h"
 #include "../framework/event_center.h"
+#include "../framework/profiler.h"
+#include "frame_sink.h"
 
 #define app Application::get_instance()
 #define DELTA_TIME 1
@@ -16,6 +18,17 @@ private:
 	int width{ 0 };
     int height{ 0 };
 
+	//headless applications hand frames to sink instead of a window
+	std::unique_ptr<Frame_sink> sink{ nullptr };
+	std::atomic<int> frame{ 0 };
+
+	//frames finished by present on another thread wait in front until handle_message shows them,
+	//HighGUI is only called from the main thread
+	std::mutex front_mutex{};
+	std::vector<u_int8_t> front{};
+	std::vector<u_int8_t> shown{};
+	bool front_ready{ false };
+
 	static decimal mouse_sensitivity;
 	static int mouse_current_x;
 	static int mouse_current_y;
@@ -23,18 +36,32 @@ private:
     Application() = default;
 
 	static void mouse_callback(int event, int x, int y, int flags, void* userdata) {
-		if (event == cv::EVENT_MOUSEMOVE) {
-			Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>::get_instance()->
-			trigger_event("on_mouse_move", {x, y},{(x - mouse_current_x) * mouse_sensitivity, (y - mouse_current_y) * mouse_sensitivity});
-			mouse_current_x = x, mouse_current_y = y;
-		} else if (event == cv::EVENT_LBUTTONDOWN) {
-			Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>::get_instance()->
-			trigger_event("on_mouse_left_button_down", {x, y},{(x - mouse_current_x) * mouse_sensitivity, (y - mouse_current_y) * mouse_sensitivity});
-			mouse_current_x = x, mouse_current_y = y;
-		} else if (event == cv::EVENT_LBUTTONUP) {
-			Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>::get_instance()->
-			trigger_event("on_mouse_left_button_up", {x, y},{(x - mouse_current_x) * mouse_sensitivity, (y - mouse_current_y) * mouse_sensitivity});
-			mouse_current_x = x, mouse_current_y = y;
+		std::string event_name;
+		if (event == cv::EVENT_MOUSEMOVE) event_name = "on_mouse_move";
+		else if (event == cv::EVENT_LBUTTONDOWN) event_name = "on_mouse_left_button_down";
+		else if (event == cv::EVENT_LBUTTONUP) event_name = "on_mouse_left_button_up";
+		else return;
+
+		std::pair<decimal, decimal> delta{(x - mouse_current_x) * mouse_sensitivity, (y - mouse_current_y) * mouse_sensitivity};
+		mouse_current_x = x, mouse_current_y = y;
+		Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>::get_instance()->trigger_event(event_name, {x, y}, delta);
+	}
+
+	void handle_key(int key) {
+        if (key == 'q') {
+            Event_center<void>::get_instance()->trigger_event("quit");
+        } else if (key == 'w') {
+	        Event_center<void>::get_instance()->trigger_event("key_w_down");
+        } else if (key== 'a') 	{
+	        Event_center<void>::get_instance()->trigger_event("key_a_down");
+		} else if (key == 's') {
+	        Event_center<void>::get_instance()->trigger_event("key_s_down");
+		} else if (key == 'd') {
+	        Event_center<void>::get_instance()->trigger_event("key_d_down");
+		} else if (key == 'z') {
+			Event_center<void>::get_instance()->trigger_event("key_z_down");
+		} else if (key == 'x') {
+			Event_center<void>::get_instance()->trigger_event("key_x_down");
 		}
 	}
 
@@ -45,18 +72,32 @@ private:
 public:
     cv::String app_id{ "app" };
     bool active{ false };
+	//headless applications quit after this many frames, 0 runs until quit is triggered
+	int frame_limit{ 0 };
 
 	void init(int width_, int height_, const std::string &app_id_ , const std::shared_ptr<u_int8_t[]>& frame_buffer) {
 		if (!frame_buffer) throw std::invalid_argument("invalid frame buffer");
-		canvas_buffer = frame_buffer;
 		app_id = app_id_, width = width_, height = height_, active = true;
-		canvas = cv::Mat(height, width, CV_8UC3, canvas_buffer.get());
+		set_canvas(frame_buffer);
 		cv::namedWindow(app_id, cv::WINDOW_NORMAL);
 		cv::resizeWindow(app_id, width, height);
 		cv::setMouseCallback(app_id, mouse_callback, nullptr);
 		register_events();
 	}
 
+	//no window is opened and no input is polled, every update presents the frame buffer to sink
+	void init_headless(int width_, int height_, const std::shared_ptr<u_int8_t[]>& frame_buffer, std::unique_ptr<Frame_sink> sink_, int frame_limit_ = 0) {
+		if (!frame_buffer) throw std::invalid_argument("invalid frame buffer");
+		if (!sink_) throw std::invalid_argument("invalid frame sink");
+		if (frame_limit_ < 0) throw std::invalid_argument("invalid frame limit");
+		app_id = "headless", width = width_, height = height_, active = true;
+		set_canvas(frame_buffer);
+		sink = std::move(sink_), frame = 0, frame_limit = frame_limit_;
+		register_events();
+	}
+
+	[[nodiscard]] bool headless() const { return sink != nullptr; }
+
     static Application* get_instance() {
         if (instance == nullptr) {
             instance = new Application();
@@ -65,29 +106,59 @@ public:
     }
 
 	void handle_message() {
-		auto key = cv::waitKey(DELTA_TIME);
-        if (key == 'q') {
-            Event_center<void>::get_instance()->trigger_event("quit");
-        } else if (key == 'w') {
-	        Event_center<void>::get_instance()->trigger_event("key_w_down");
-        } else if (key== 'a') 	{
-	        Event_center<void>::get_instance()->trigger_event("key_a_down");
-		} else if (key == 's') {
-	        Event_center<void>::get_instance()->trigger_event("key_s_down");
-		} else if (key == 'd') {
-	        Event_center<void>::get_instance()->trigger_event("key_d_down");
-		} else if (key == 'z') {
-			Event_center<void>::get_instance()->trigger_event("key_z_down");
-		} else if (key == 'x') {
-			Event_center<void>::get_instance()->trigger_event("key_x_down");
+		TRACE_SCOPE("handle_message");
+		if (headless()) {
+			if (frame_limit && frame >= frame_limit) Event_center<void>::get_instance()->trigger_event("quit");
+			return;
+		}
+		bool ready;
+		{
+			std::lock_guard<std::mutex> lock(front_mutex);
+			ready = front_ready, front_ready = false;
+			if (ready) front.swap(shown);
 		}
+		if (ready) cv::imshow(app_id, cv::Mat(height, width, CV_8UC3, shown.data()));
+		handle_key(cv::waitKey(DELTA_TIME));
+	}
+
+	//points the canvas at the frame buffer being rendered, call it whenever the gpu switches buffers
+	void set_canvas(const std::shared_ptr<u_int8_t[]>& frame_buffer) {
+		if (!frame_buffer) throw std::invalid_argument("invalid frame buffer");
+		canvas_buffer = frame_buffer;
+		canvas = cv::Mat(height, width, CV_8UC3, canvas_buffer.get());
 	}
 
-    void update() const {
+    void update() {
+        TRACE_SCOPE("update");
+        if (headless()) {
+            sink->present(canvas_buffer.get(), width, height, frame ++);
+            return;
+        }
         cv::imshow(app_id, canvas);
     }
 
-    static void exit() {
+    //exports or hands over a finished frame, called by the present thread of a Swap_chain instead of update.
+    //a window shows the last frame handed over on the next handle_message, a headless application drops
+    //the frames past frame_limit still in flight when it quits
+    void present(const u_int8_t* pixels) {
+        TRACE_SCOPE("present");
+        if (headless()) {
+            int index = frame;
+            if (frame_limit && index >= frame_limit) return;
+            sink->present(pixels, width, height, index);
+            frame = index + 1;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(front_mutex);
+        front.assign(pixels, pixels + width * height * 3);
+        front_ready = true;
+    }
+
+    void exit() {
+        if (headless()) {
+            sink.reset();
+            return;
+        }
         cv::destroyAllWindows();
     }
     
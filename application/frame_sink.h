@@ -0,0 +1,101 @@
+#pragma once
+
+#include "base.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// receives the finished frames of a headless application, pixels are 8 bit bgr rows from top to bottom
+class Frame_sink {
+public:
+	virtual ~Frame_sink() = default;
+	virtual void present(const u_int8_t* pixels, int width, int height, int frame) = 0;
+};
+
+// drops every frame, for timing the renderer alone
+class Null_sink : public Frame_sink {
+public:
+	void present(const u_int8_t* pixels, int width, int height, int frame) override { }
+};
+
+// writes every frame to an image file, pattern is a printf format taking the frame number
+// such as "frame_%05d.png", the extension picks the format
+class File_sink : public Frame_sink {
+private:
+	std::string pattern{};
+
+public:
+	explicit File_sink(std::string pattern_) : pattern(std::move(pattern_)) {
+		if (pattern.empty()) throw std::invalid_argument("invalid file pattern");
+	}
+
+	[[nodiscard]] std::string path(int frame) const {
+		int size = std::snprintf(nullptr, 0, pattern.c_str(), frame);
+		std::string result(size, '\0');
+		std::snprintf(result.data(), size + 1, pattern.c_str(), frame);
+		return result;
+	}
+
+	void present(const u_int8_t* pixels, int width, int height, int frame) override {
+		cv::Mat image(height, width, CV_8UC3, const_cast<u_int8_t*>(pixels));
+		if (!cv::imwrite(path(frame), image)) throw std::runtime_error("Error: Unable to write frame");
+	}
+};
+
+// publishes the latest frame in a posix shared memory object for another process to read.
+// the object starts with a Header, the pixels follow it. sequence is odd while a frame is
+// being copied, a reader retries when it changed or was odd around its own copy
+class Shared_memory_sink : public Frame_sink {
+public:
+	struct Header {
+		std::atomic<uint64_t> sequence;
+		int32_t width, height, frame;
+
+		//the pixels start sizeof(Header) bytes after the header
+		u_int8_t* pixels() { return reinterpret_cast<u_int8_t*>(this) + sizeof(Header); }
+		[[nodiscard]] const u_int8_t* pixels() const { return reinterpret_cast<const u_int8_t*>(this) + sizeof(Header); }
+	};
+
+private:
+	std::string name{};
+	int width{ 0 }, height{ 0 };
+	size_t size{ 0 };
+	void* memory{ nullptr };
+
+public:
+	//name starts with a slash, such as "/soft_renderer"
+	Shared_memory_sink(std::string name_, int width_, int height_) : name(std::move(name_)), width(width_), height(height_) {
+		if (width <= 0 || height <= 0) throw std::invalid_argument("invalid frame size");
+		size = sizeof(Header) + (size_t)width * height * 3;
+		int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+		if (fd < 0) throw std::runtime_error("Error: Unable to open shared memory");
+		if (ftruncate(fd, (off_t)size) != 0) {
+			close(fd);
+			throw std::runtime_error("Error: Unable to size shared memory");
+		}
+		memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+		if (memory == MAP_FAILED) throw std::runtime_error("Error: Unable to map shared memory");
+
+		auto header = new (memory) Header{};
+		header->width = width, header->height = height, header->frame = -1;
+	}
+
+	~Shared_memory_sink() override {
+		munmap(memory, size);
+		shm_unlink(name.c_str());
+	}
+
+	Shared_memory_sink(const Shared_memory_sink&) = delete;
+	Shared_memory_sink& operator=(const Shared_memory_sink&) = delete;
+
+	void present(const u_int8_t* pixels, int width_, int height_, int frame) override {
+		if (width_ != width || height_ != height) throw std::invalid_argument("frame size mismatch");
+		auto header = static_cast<Header*>(memory);
+		header->sequence.fetch_add(1, std::memory_order_acq_rel);
+		std::memcpy(header->pixels(), pixels, (size_t)width * height * 3);
+		header->frame = frame;
+		header->sequence.fetch_add(1, std::memory_order_release);
+	}
+};
@@ -2,6 +2,7 @@
 
 #include "base.h"
 #include "color.h"
+#include "../framework/profiler.h"
 
 enum WRAP_MODE {
     NONE,
@@ -24,6 +25,7 @@ public:
     Image(int width_, int height_) : width(width_), height(height_), data(std::make_unique<math::Color[]>(width_ * height_)) { }
 
     explicit Image(const std::string& path) {
+        TRACE_SCOPE("image_load");
         cv::Mat image = cv::imread(path, cv::IMREAD_UNCHANGED);
 
         if (image.empty()) throw std::runtime_error("Error: Unable to load image");
@@ -3,7 +3,12 @@
 #include <opencv2/opencv.hpp>
 #include <bits/stdc++.h>
 
+//SOFT_RENDERER_FLOAT builds the math and the pipeline in single precision
+#if defined(SOFT_RENDERER_FLOAT)
+using decimal = float;
+#else
 using decimal = double;
+#endif
 using varied_type = std::variant<float, double, long double, int, long long, char>;
 
 inline decimal PI() { return acos(-1); }
@@ -32,7 +37,8 @@ concept Equal = (P == Q);
 template<typename Base, typename Derived>
 concept Inherited = std::is_base_of_v<Base, Derived>;
 
-constexpr double eps = 1e-8;
+//float keeps about 7 significant digits, tolerances are scaled to match
+constexpr decimal eps = std::is_same_v<decimal, float> ? (decimal)1e-5 : (decimal)1e-8;
 
 inline bool equal(const decimal& a, const decimal& b) {
     return (std::fabs(a - b) < eps);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "base.h"
+
+//keeps the compiler from optimizing away a value computed by a benchmark
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// times a kernel in samples of a calibrated number of calls, the median sample is reported
+// with the spread of the samples around it. items_per_op gives the pixels or triangles handled
+// by one call, to report a throughput next to ns/op
+class Bench {
+public:
+	struct Result {
+		std::string name;
+		double ns_per_op{ 0.0 };
+		//median absolute deviation relative to the median, in percent
+		double spread{ 0.0 };
+		double items_per_second{ 0.0 };
+		std::string unit;
+	};
+
+	int samples{ 15 };
+	std::chrono::nanoseconds sample_time{ std::chrono::milliseconds(20) };
+	//only benchmarks whose name contains filter run
+	std::string filter{};
+
+private:
+	std::vector<Result> results{};
+
+	template<typename F>
+	static double time_calls(F& f, int64_t calls) {
+		auto start = std::chrono::steady_clock::now();
+		for (int64_t i = 0; i < calls; i ++) f();
+		auto end = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	}
+
+	static double median(std::vector<double> values) {
+		std::sort(values.begin(), values.end());
+		auto n = values.size();
+		return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+	}
+
+public:
+	template<typename F>
+	void run(const std::string& name, const std::string& unit, double items_per_op, F&& f) {
+		if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+		//warm up, then grow the call count until one sample takes sample_time
+		f();
+		int64_t calls = 1;
+		while (calls < (int64_t{ 1 } << 40)) {
+			auto elapsed = time_calls(f, calls);
+			if (elapsed >= (double)sample_time.count()) break;
+			calls = elapsed <= 0.0 ? calls * 10 : std::max(calls + 1, (int64_t)(calls * 1.2 * sample_time.count() / elapsed));
+		}
+
+		std::vector<double> per_op;
+		for (int i = 0; i < samples; i ++) per_op.push_back(time_calls(f, calls) / calls);
+
+		double ns = median(per_op);
+		std::vector<double> deviations;
+		for (auto value : per_op) deviations.push_back(std::fabs(value - ns));
+		double spread = ns > 0.0 ? median(deviations) / ns * 100.0 : 0.0;
+
+		results.push_back({name, ns, spread, ns > 0.0 ? items_per_op * 1e9 / ns : 0.0, unit});
+		print(std::cout, results.back());
+	}
+
+	[[nodiscard]] const std::vector<Result>& get_results() const { return results; }
+
+	static void print_header(std::ostream& os) {
+		os << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "ns/op"
+			<< std::setw(10) << "+-%" << std::setw(16) << "throughput" << std::endl;
+	}
+
+	static void print(std::ostream& os, const Result& result) {
+		os << std::left << std::setw(40) << result.name << std::right << std::fixed
+			<< std::setw(14) << std::setprecision(1) << result.ns_per_op
+			<< std::setw(10) << std::setprecision(2) << result.spread;
+		if (!result.unit.empty()) os << std::setw(16) << std::setprecision(3) << result.items_per_second / 1e6 << " M" << result.unit << "/s";
+		os << std::endl;
+	}
+
+	void write_csv(std::ostream& os) const {
+		os << "benchmark,ns_per_op,spread_percent,items_per_second,unit" << std::endl;
+		for (auto &result : results) {
+			os << result.name << "," << result.ns_per_op << "," << result.spread << "," << result.items_per_second << "," << result.unit << std::endl;
+		}
+	}
+
+};
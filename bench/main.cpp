@@ -0,0 +1,214 @@
+#include "base.h"
+#include "gpu.h"
+#include "raster.h"
+#include "camera.h"
+#include "bench.h"
+
+// soft_renderer_bench [filter] [--samples n] [--csv path]
+// prints ns/op and throughput of the rasterizer, clipper, texture sampling, matrix and full
+// draw kernels. Every benchmark builds its own input, nothing is read from disk
+
+Vertex_shader_data screen_vertex(decimal x, decimal y, const math::Color_decimal& color = {1.0, 1.0, 1.0, 1.0}) {
+	return {math::homo_point(x, y, 0.5), color, {x / 256.0, y / 256.0}, 1.0};
+}
+
+void bench_raster(Bench& bench) {
+	struct Shape { std::string name; std::array<Vertex_shader_data, 3> vertices; };
+	std::vector<Shape> shapes{
+		{"small", {screen_vertex(10.3, 10.7), screen_vertex(14.1, 11.2), screen_vertex(11.6, 14.9)}},
+		{"medium", {screen_vertex(10.3, 10.7), screen_vertex(42.8, 14.2), screen_vertex(20.5, 44.1)}},
+		{"large", {screen_vertex(5.3, 4.7), screen_vertex(260.8, 20.2), screen_vertex(40.5, 250.1)}},
+		{"sliver", {screen_vertex(2.3, 3.7), screen_vertex(250.8, 9.2), screen_vertex(251.5, 10.4)}},
+	};
+	std::pair<math::Pixel, math::Pixel> bounds{{0, 0}, {511, 511}};
+
+	for (auto &[name, vertices] : shapes) {
+		for (int msaa : {1, 2, 4}) {
+			auto& [a, b, c] = vertices;
+			int64_t fragments = 0;
+			auto raster = [&]() {
+				Raster::triangle_shader_data(a, b, c, msaa, bounds, [&](const Vertex_shader_data& fragment) {
+					fragments ++;
+					do_not_optimize(fragment);
+				});
+			};
+			raster();
+			double pixels = (double)fragments;
+			bench.run("raster/" + name + "/msaa" + std::to_string(msaa), "pixel", pixels, raster);
+
+			auto raster_fixed = [&]() {
+				Raster::triangle_shader_data_fixed(a, b, c, msaa, bounds, [&](const Vertex_shader_data& fragment) {
+					do_not_optimize(fragment);
+				});
+			};
+			bench.run("raster_fixed/" + name + "/msaa" + std::to_string(msaa), "pixel", pixels, raster_fixed);
+		}
+	}
+}
+
+void bench_image(Bench& bench) {
+	Image image(256, 256);
+	for (int y = 0; y < image.height; y ++)
+		for (int x = 0; x < image.width; x ++) image.at(x, y) = math::Color(x, y, x ^ y);
+
+	const int sample_count = 1024;
+	std::vector<std::pair<decimal, decimal>> uvs;
+	for (int i = 0; i < sample_count; i ++) uvs.emplace_back(fraction(i * 0.618034), fraction(i * 0.414214));
+
+	for (auto wrap_mode : {WRAP_MODE::NONE, WRAP_MODE::REPEAT, WRAP_MODE::MIRROR}) {
+		std::string name = wrap_mode == WRAP_MODE::NONE ? "none" : wrap_mode == WRAP_MODE::REPEAT ? "repeat" : "mirror";
+		bench.run("image/at_uv_bilinear/" + name, "sample", sample_count, [&]() {
+			for (auto &[u, v] : uvs) do_not_optimize(image.at_uv_bilinear(u, v, wrap_mode));
+		});
+	}
+}
+
+void bench_matrix(Bench& bench) {
+	math::Mat4x4 a = math::rotate({0.0, 1.0, 0.0}, 30.0) * math::translate(1.0, 2.0, 3.0);
+	math::Mat4x4 b = math::rotate({1.0, 0.0, 0.0}, 45.0);
+	bench.run("mat4x4/multiply", "", 1.0, [&]() {
+		a = a * b;
+		do_not_optimize(a);
+	});
+	math::Homo3d point = math::homo_point(1.0, 2.0, 3.0);
+	bench.run("mat4x4/transform_point", "", 1.0, [&]() {
+		do_not_optimize(b * point);
+	});
+}
+
+// the pipeline reads the position, color and uv attributes from vaos 1 to 3,
+// so they are generated once and every scene rebinds its vbos to them
+const std::array<int, 3>& vertex_arrays() {
+	static std::array<int, 3> vaos = []() {
+		std::array<int, 3> result{};
+		for (auto &vao : result) vao = gpu->generate(OBJECT::VERTEX_ARRAY);
+		return result;
+	}();
+	return vaos;
+}
+
+// an indexed triangle mesh loaded into fresh ebo and vbos
+struct Scene {
+	std::vector<decimal> positions, colors, uvs;
+	std::vector<int> indices;
+
+	void add_vertex(decimal x, decimal y, decimal z) {
+		indices.push_back((int)positions.size() / 3);
+		positions.insert(positions.end(), {x, y, z});
+		colors.insert(colors.end(), {1.0, 0.0, 0.0, 1.0});
+		uvs.insert(uvs.end(), {0.0, 0.0});
+	}
+
+	[[nodiscard]] int triangles() const { return (int)indices.size() / 3; }
+
+	void load() const {
+		auto& vaos = vertex_arrays();
+		int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo);
+		gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices.data(), (int)indices.size());
+		std::array<std::pair<const std::vector<decimal>*, int>, 3> attributes{{{&positions, 3}, {&colors, 4}, {&uvs, 2}}};
+		for (int i = 0; i < 3; i ++) {
+			gpu->bind(OBJECT::VERTEX_ARRAY, vaos[i]);
+			int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo);
+			gpu->set_vertex_array({vbo, attributes[i].second, 0, attributes[i].second});
+			gpu->set_buffer(OBJECT::VERTEX_BUFFER, attributes[i].first->data(), (int)attributes[i].first->size());
+		}
+	}
+};
+
+// small triangles in front of the camera, crossing the near plane or beside the frustum, drawn
+// into a 4 x 4 frame buffer so that clipping and culling dominate the cost of the draw
+void bench_clip_cull(Bench& bench) {
+	const int triangle_count = 4096;
+	gpu->init(4, 4);
+	Camera camera(70.0, 1.0, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 0.0});
+	gpu->set_shader(Default_Shader(math::Transform3d::identity(), camera.get_view_matrix(), camera.get_projection_matrix()));
+
+	//x and y offsets of a triangle's vertices, the third vertex is placed at z
+	struct Case { std::string name; decimal x, z; };
+	for (auto &[name, x, z] : std::vector<Case>{{"inside", 0.0, 5.0}, {"crossing", 0.0, -1.0}, {"outside", 50.0, 5.0}}) {
+		Scene scene;
+		for (int i = 0; i < triangle_count; i ++) {
+			decimal jitter = i * 0.0001;
+			scene.add_vertex(x - 0.1 + jitter, -0.1, 5.0);
+			scene.add_vertex(x + 0.1 + jitter, -0.1, 5.0);
+			scene.add_vertex(x + jitter, 0.1, z);
+		}
+		scene.load();
+		bench.run("clip_cull/" + name, "triangle", scene.triangles(), [&]() {
+			gpu->clear();
+			gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+		});
+	}
+}
+
+// a grid of quads facing the camera, drawn once per op
+struct Grid_scene : public Scene {
+	int quads;
+
+	explicit Grid_scene(int quads_) : quads(quads_) {
+		for (int y = 0; y <= quads; y ++)
+			for (int x = 0; x <= quads; x ++) {
+				decimal u = (decimal)x / quads, v = (decimal)y / quads;
+				positions.insert(positions.end(), {u * 8 - 4, v * 6 - 3, 0.0});
+				colors.insert(colors.end(), {u, v, 1 - u, 1.0});
+				uvs.insert(uvs.end(), {u, v});
+			}
+		for (int y = 0; y < quads; y ++)
+			for (int x = 0; x < quads; x ++) {
+				int i = y * (quads + 1) + x;
+				indices.insert(indices.end(), {i, i + 1, i + quads + 2, i, i + quads + 2, i + quads + 1});
+			}
+	}
+};
+
+void bench_draw(Bench& bench) {
+	int width = 400, height = 300;
+	gpu->init(width, height);
+	Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -5.0});
+	Default_Shader shader(math::rotate({0.0, 1.0, 0.0}, 20.0), camera.get_view_matrix(), camera.get_projection_matrix());
+
+	for (int quads : {4, 32, 128}) {
+		Grid_scene scene(quads);
+		scene.load();
+		gpu->set_shader(shader);
+
+		for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+			gpu->pipeline_mode = mode;
+			std::string name = mode == PIPELINE_MODE::IMMEDIATE ? "immediate" : mode == PIPELINE_MODE::BINNED ? "binned" : "streaming";
+			bench.run("draw/grid" + std::to_string(quads) + "/" + name, "triangle", scene.triangles(), [&]() {
+				gpu->clear();
+				gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+			});
+			bench.run("draw/grid" + std::to_string(quads) + "/" + name + "/static", "triangle", scene.triangles(), [&]() {
+				gpu->clear();
+				gpu->draw_primitive<Default_Shader>(PRIMITIVE::TRIANGLE);
+			});
+		}
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+}
+
+int main(int argc, char** argv) {
+	Bench bench;
+	std::string csv_path;
+	for (int i = 1; i < argc; i ++) {
+		std::string arg = argv[i];
+		if (arg == "--samples" && i + 1 < argc) bench.samples = std::max(1, std::stoi(argv[++ i]));
+		else if (arg == "--csv" && i + 1 < argc) csv_path = argv[++ i];
+		else bench.filter = arg;
+	}
+
+	Bench::print_header(std::cout);
+	bench_raster(bench);
+	bench_clip_cull(bench);
+	bench_image(bench);
+	bench_matrix(bench);
+	bench_draw(bench);
+
+	if (!csv_path.empty()) {
+		std::ofstream csv(csv_path);
+		if (!csv) throw std::runtime_error("Error: Unable to open csv file");
+		bench.write_csv(csv);
+	}
+	return 0;
+}
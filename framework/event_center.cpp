@@ -2,8 +2,8 @@
 #include "event_center.h"
 
 template<>
-Event_center<void, std::pair<int, int>, std::pair<double, double>>*
-Event_center<void, std::pair<int, int>, std::pair<double, double>>::instance = nullptr;
+Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>*
+Event_center<void, std::pair<int, int>, std::pair<decimal, decimal>>::instance = nullptr;
 
 template<>
 Event_center<void>*
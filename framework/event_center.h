@@ -6,9 +6,11 @@ template<typename T, typename ...Args>
 class Event_center {
 private:
 	static Event_center* instance;
-	Event_center() = default;
 	std::unordered_map<std::string, std::function<T(Args...)>> events;
 public:
+	//independent centers for separate contexts, get_instance returns the one shared by the application
+	Event_center() = default;
+
 	static Event_center* get_instance() {
 		if (instance == nullptr) {
 			instance = new Event_center();
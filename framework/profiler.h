@@ -0,0 +1,156 @@
+#pragma once
+
+#include "base.h"
+
+// scoped wall clock timers exported as chrome trace events (chrome://tracing or ui.perfetto.dev).
+// every thread records into its own ring buffer without locking, the oldest events are overwritten
+// once a ring is full. a ring goes back to a free list when its thread exits and is handed to the
+// next new thread, so the number of rings stays at the most threads ever recording at once.
+// the ring keeps its thread_id, a trace lane therefore holds the events of every thread that
+// owned its ring, one after the other. recording only happens when built with
+// SOFT_RENDERER_TRACE, otherwise TRACE_SCOPE and TRACE_DUMP compile to nothing
+class Profiler {
+public:
+	struct Event {
+		//string literal, only the pointer is stored
+		const char* name{ nullptr };
+		int64_t start{ 0 }, duration{ 0 };
+	};
+
+	static constexpr int ring_capacity = 1 << 16;
+
+	//written by its owning thread only, readers see the events below head
+	struct Ring {
+		int thread_id{ 0 };
+		std::unique_ptr<Event[]> events = std::make_unique<Event[]>(ring_capacity);
+		std::atomic<int64_t> head{ 0 };
+
+		void push(const Event& event) {
+			auto index = head.load(std::memory_order_relaxed);
+			events[index & (ring_capacity - 1)] = event;
+			head.store(index + 1, std::memory_order_release);
+		}
+	};
+
+private:
+	std::mutex mutex{};
+	//rings outlive their threads so events of finished workers are still dumped,
+	//until the thread reusing the ring overwrites them
+	std::vector<std::unique_ptr<Ring>> rings{};
+	std::vector<Ring*> free_rings{};
+	std::chrono::steady_clock::time_point epoch{ std::chrono::steady_clock::now() };
+	std::string exit_path{};
+
+	//thread local, releases the ring of its thread when the thread exits
+	struct Ring_owner {
+		Ring* ring{ nullptr };
+		~Ring_owner() { get_instance()->release(ring); }
+	};
+
+	Profiler() = default;
+
+	Ring* acquire() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!free_rings.empty()) {
+			auto ring = free_rings.back();
+			free_rings.pop_back();
+			return ring;
+		}
+		rings.push_back(std::make_unique<Ring>());
+		rings.back()->thread_id = (int)rings.size();
+		return rings.back().get();
+	}
+
+	void release(Ring* ring) {
+		std::lock_guard<std::mutex> lock(mutex);
+		free_rings.push_back(ring);
+	}
+
+public:
+	static Profiler* get_instance() {
+		static Profiler instance;
+		return &instance;
+	}
+
+	//nanoseconds since the profiler was created
+	[[nodiscard]] int64_t now() const {
+		auto elapsed = std::chrono::steady_clock::now() - epoch;
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	}
+
+	//ring of the calling thread, acquired on first use
+	Ring& ring() {
+		thread_local Ring_owner owner{ acquire() };
+		return *owner.ring;
+	}
+
+	[[nodiscard]] int ring_count() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return (int)rings.size();
+	}
+
+	void record(const char* name, int64_t start, int64_t end) {
+		ring().push({name, start, end - start});
+	}
+
+	//writes the recorded events as a chrome trace event json array. events written while
+	//dumping may be torn, dump between frames or after the worker threads are idle
+	void dump(std::ostream& os) {
+		std::lock_guard<std::mutex> lock(mutex);
+		os << "[" << std::endl;
+		bool first = true;
+		for (auto &ring : rings) {
+			auto head = ring->head.load(std::memory_order_acquire);
+			for (auto i = std::max<int64_t>(0, head - ring_capacity); i < head; i ++) {
+				auto& event = ring->events[i & (ring_capacity - 1)];
+				if (!first) os << "," << std::endl;
+				first = false;
+				os << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->thread_id
+					<< std::fixed << std::setprecision(3)
+					<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+			}
+		}
+		os << std::endl << "]" << std::endl;
+	}
+
+	void dump(const std::string& path) {
+		std::ofstream file(path);
+		if (!file) throw std::runtime_error("Error: Unable to open trace file");
+		dump(file);
+	}
+
+	//dumps to path when the program exits normally
+	void dump_at_exit(const std::string& path) {
+		bool registered = !exit_path.empty();
+		exit_path = path;
+		if (!registered) std::atexit([]() { get_instance()->dump(get_instance()->exit_path); });
+	}
+
+};
+
+// times the enclosing scope
+class Trace_scope {
+private:
+	const char* name{ nullptr };
+	int64_t start{ 0 };
+
+public:
+	explicit Trace_scope(const char* name_) : name(name_), start(Profiler::get_instance()->now()) { }
+	~Trace_scope() { Profiler::get_instance()->record(name, start, Profiler::get_instance()->now()); }
+
+	Trace_scope(const Trace_scope&) = delete;
+	Trace_scope& operator=(const Trace_scope&) = delete;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef SOFT_RENDERER_TRACE
+#define TRACE_SCOPE(name) Trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_DUMP(path) Profiler::get_instance()->dump(path)
+#define TRACE_DUMP_AT_EXIT(path) Profiler::get_instance()->dump_at_exit(path)
+#else
+#define TRACE_SCOPE(name) do { } while (0)
+#define TRACE_DUMP(path) do { } while (0)
+#define TRACE_DUMP_AT_EXIT(path) do { } while (0)
+#endif
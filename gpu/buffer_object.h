@@ -11,6 +11,22 @@ struct VAO {
 	}
 };
 
+//one record of a draw indirect buffer, stored as size ints
+struct Draw_indirect_command {
+	static constexpr int size = 4;
+	int count{ 0 }, first_index{ 0 }, base_vertex{ 0 }, instance_count{ 0 };
+};
+
+//one attribute resolved from a VAO to its VBO memory, read without copying
+struct Vertex_stream {
+	const decimal* data{ nullptr };
+	int stride{ 0 }, offset{ 0 };
+	//number of vertices whose items lie inside the vbo
+	int count{ 0 };
+
+	const decimal* operator[](int index) const { return data + index * stride + offset; }
+};
+
 template<typename T>
 class Buffer_object {
 private:
@@ -28,6 +44,9 @@ public:
 
 	int size_buffer{ 0 }, size_data{ 0 };
 
+	//no copy, valid until the next set_buffer_data
+	[[nodiscard]] const T* get_data() const { return data.get(); }
+
 	std::unique_ptr<T[]> get_buffer_data(int index, int stride, int offset, int item_size) {
 		int pointer = index * stride + offset;
 		std::unique_ptr<T[]> result(std::make_unique<T[]>(item_size));
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "base.h"
+#include "gpu.h"
+
+// records binds, buffer uploads, shader and state changes and draws without touching the GPU,
+// buffers can be recorded on several threads at once and are executed in order by GPU::submit.
+// objects are still generated on the GPU up front, commands only refer to their ids
+class Command_buffer {
+public:
+	struct Bind { OBJECT object; int id; };
+	struct Set_buffer { OBJECT object; std::vector<char> data; int size; };
+	struct Set_vertex_array { VAO vao; };
+	struct Set_shader { std::function<std::unique_ptr<Shader>()> create; };
+	struct Update_shader { std::function<void(Shader&)> update; };
+	struct Set_state { std::function<void(GPU&)> apply; };
+	struct Clear {};
+	struct Draw { PRIMITIVE primitive; };
+	struct Set_instance_array { VAO vao; };
+	struct Draw_instanced { PRIMITIVE primitive; int instance_count; };
+	struct Draw_indirect { PRIMITIVE primitive; int draw_count, first_draw; };
+
+	using Command = std::variant<Bind, Set_buffer, Set_vertex_array, Set_shader, Update_shader, Set_state, Clear, Draw, Set_instance_array, Draw_instanced, Draw_indirect>;
+
+private:
+	std::vector<Command> commands{};
+
+public:
+	Command_buffer() = default;
+
+	[[nodiscard]] const std::vector<Command>& get_commands() const { return commands; }
+	[[nodiscard]] int size() const { return (int)commands.size(); }
+
+	void reset() { commands.clear(); }
+
+	void bind(OBJECT object, int id) {
+		commands.emplace_back(Bind{object, id});
+	}
+
+	//the data is copied when recorded
+	template<typename T>
+	void set_buffer(OBJECT object, const T* data, int size) {
+		if (!data) throw std::invalid_argument("data is invalid");
+		int item_size = 0;
+		if (object == OBJECT::VERTEX_BUFFER) item_size = sizeof(decimal);
+		else if (object == OBJECT::ELEMENT_BUFFER || object == OBJECT::DRAW_INDIRECT_BUFFER) item_size = sizeof(int);
+		else throw std::invalid_argument("invalid object");
+
+		auto bytes = reinterpret_cast<const char*>(data);
+		commands.emplace_back(Set_buffer{object, std::vector<char>(bytes, bytes + (size_t)size * item_size), size});
+	}
+
+	void set_vertex_array(const VAO& vao) {
+		commands.emplace_back(Set_vertex_array{vao});
+	}
+
+	//the shader is copied when recorded, every submit binds a fresh copy of it
+	template<typename T>
+	void set_shader(const T& shader_) requires Inherited<Shader, typename std::remove_reference<T>::type> {
+		auto recorded = std::make_shared<T>(shader_);
+		commands.emplace_back(Set_shader{[recorded]() -> std::unique_ptr<Shader> { return std::make_unique<T>(*recorded); }});
+	}
+
+	//changes uniforms of the bound shader, which must be a T at execution time
+	template<typename T>
+	void update_shader(std::function<void(T&)> update) requires Inherited<Shader, T> {
+		commands.emplace_back(Update_shader{[update = std::move(update)](Shader& shader_) {
+			auto typed = dynamic_cast<T*>(&shader_);
+			if (!typed) throw std::invalid_argument("shader type mismatch");
+			update(*typed);
+		}});
+	}
+
+	//pipeline configuration such as cull_type, MSAA or depth_test_enabled
+	void set_state(std::function<void(GPU&)> apply) {
+		commands.emplace_back(Set_state{std::move(apply)});
+	}
+
+	void clear() {
+		commands.emplace_back(Clear{});
+	}
+
+	void draw_primitive(PRIMITIVE primitive) {
+		commands.emplace_back(Draw{primitive});
+	}
+
+	void set_instance_array(const VAO& vao) {
+		commands.emplace_back(Set_instance_array{vao});
+	}
+
+	void draw_primitive_instanced(PRIMITIVE primitive, int instance_count) {
+		commands.emplace_back(Draw_instanced{primitive, instance_count});
+	}
+
+	//the records are read from the draw indirect buffer when the command is executed
+	void multi_draw_indirect(PRIMITIVE primitive, int draw_count, int first_draw = 0) {
+		commands.emplace_back(Draw_indirect{primitive, draw_count, first_draw});
+	}
+
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "base.h"
+#include "command_buffer.h"
+
+// state and depth of a queued draw packed into 64 bits, most significant bits first:
+// opaque  : 0 | shader 10 | material 10 | texture 11 | depth 32, front to back
+// blended : 1 | depth 32, back to front | shader 10 | material 10 | texture 11
+// opaque draws run first grouped by state, blended draws are ordered by depth only then
+struct Sort_key {
+	static constexpr int shader_bits = 10, material_bits = 10, texture_bits = 11, depth_bits = 32;
+
+	bool blended{ false };
+	int shader{ 0 }, material{ 0 }, texture{ 0 };
+	//distance from the camera, greater is farther
+	decimal depth{ 0.0 };
+
+	[[nodiscard]] uint64_t encode() const {
+		auto field = [](int value, int bits) {
+			if (value < 0 || value >= (1 << bits)) throw std::out_of_range("sort key field out of range");
+			return (uint64_t)value;
+		};
+		uint64_t state = field(shader, shader_bits) << (material_bits + texture_bits)
+			| field(material, material_bits) << texture_bits
+			| field(texture, texture_bits);
+
+		//the bits of a non negative float grow with its value
+		auto distance = (float)(depth > 0.0 ? depth : 0.0);
+		uint64_t depth_key = std::bit_cast<uint32_t>(distance);
+
+		if (!blended) return state << depth_bits | depth_key;
+		uint64_t far_first = ~depth_key & 0xffffffffull;
+		return 1ull << 63 | far_first << (shader_bits + material_bits + texture_bits) | state;
+	}
+};
+
+// draws queued with a sort key, every command buffer must bind all the state its draw needs
+// since the queue may execute them in a different order. submitted by GPU::submit
+class Draw_queue {
+private:
+	std::vector<uint64_t> keys{};
+	std::vector<Command_buffer> items{};
+
+public:
+	Draw_queue() = default;
+
+	[[nodiscard]] int size() const { return (int)items.size(); }
+	[[nodiscard]] const Command_buffer& at(int i) const { return items[i]; }
+	[[nodiscard]] uint64_t key(int i) const { return keys[i]; }
+
+	void reset() {
+		keys.clear();
+		items.clear();
+	}
+
+	void push(const Sort_key& key, Command_buffer commands) {
+		keys.push_back(key.encode());
+		items.push_back(std::move(commands));
+	}
+
+	//item indices by ascending key, queued order for equal keys
+	[[nodiscard]] std::vector<int> sorted_order() const {
+		std::vector<int> order(items.size());
+		std::iota(order.begin(), order.end(), 0);
+		radix_sort(keys, order);
+		return order;
+	}
+
+	//stable lsd radix sort of order by keys[order[i]], a byte every pass,
+	//passes where all keys share the byte are skipped
+	static void radix_sort(const std::vector<uint64_t>& keys, std::vector<int>& order) {
+		std::vector<int> buffer(order.size());
+		for (int shift = 0; shift < 64; shift += 8) {
+			std::array<int, 257> offsets{};
+			for (int i : order) offsets[(keys[i] >> shift & 0xff) + 1] ++;
+			if (std::any_of(offsets.begin() + 1, offsets.end(), [&](int count) { return count == (int)order.size(); })) continue;
+
+			for (int b = 0; b < 256; b ++) offsets[b + 1] += offsets[b];
+			for (int i : order) buffer[offsets[keys[i] >> shift & 0xff] ++] = i;
+			order.swap(buffer);
+		}
+	}
+
+};
@@ -8,22 +8,61 @@ public:
 	int width{ 0 };
 	int height{ 0 };
 
+	//edge length of the coarse depth tiles
+	static constexpr int depth_tile_size = 8;
+	int depth_tiles_x{ 0 };
+	int depth_tiles_y{ 0 };
+
 	std::shared_ptr<math::BGR[]> color_buffer{ nullptr }; // Use shared_ptr
 	std::shared_ptr<decimal[]> depth_buffer{ nullptr };   // Use shared_ptr
 
+	//smallest depth of every tile, recomputed lazily once a depth inside the tile was written
+	std::shared_ptr<decimal[]> depth_tile_buffer{ nullptr };
+	std::shared_ptr<bool[]> depth_tile_dirty{ nullptr };
+
 	Frame_buffer() = default;
 
 	Frame_buffer(int width_, int height_) : width(width_), height(height_) {
+		depth_tiles_x = (width_ + depth_tile_size - 1) / depth_tile_size;
+		depth_tiles_y = (height_ + depth_tile_size - 1) / depth_tile_size;
 		color_buffer = std::shared_ptr<math::BGR[]>(new math::BGR[width_ * height_]);
 		depth_buffer = std::shared_ptr<decimal[]>(new decimal[width_ * height_]);
-		std::fill_n(depth_buffer.get(), width_ * height_, -2.0);
+		depth_tile_buffer = std::shared_ptr<decimal[]>(new decimal[depth_tiles_x * depth_tiles_y]);
+		depth_tile_dirty = std::shared_ptr<bool[]>(new bool[depth_tiles_x * depth_tiles_y]);
+		clear();
 	}
 
 	void clear() {
 		std::fill_n(depth_buffer.get(), width * height, -2.0);
+		std::fill_n(depth_tile_buffer.get(), depth_tiles_x * depth_tiles_y, -2.0);
+		std::fill_n(depth_tile_dirty.get(), depth_tiles_x * depth_tiles_y, false);
 		memset(color_buffer.get(), 0, width * height * sizeof(math::BGR));
 	}
 
+	//writes through here keep the coarse depth tiles valid, depth_at does not
+	void set_depth(int x, int y, decimal depth) {
+		depth_at(x, y) = depth;
+		depth_tile_dirty.get()[(y / depth_tile_size) * depth_tiles_x + x / depth_tile_size] = true;
+	}
+
+	//smallest depth of the tile containing pixel (x, y)
+	decimal tile_min_depth(int x, int y) {
+		if (x < 0 || x >= width) throw std::out_of_range("out of range");
+		if (y < 0 || y >= height) throw std::out_of_range("out of range");
+		int tile = (y / depth_tile_size) * depth_tiles_x + x / depth_tile_size;
+		auto& min_depth = depth_tile_buffer.get()[tile];
+		if (depth_tile_dirty.get()[tile]) {
+			int x0 = x / depth_tile_size * depth_tile_size, y0 = y / depth_tile_size * depth_tile_size;
+			int x1 = std::min(x0 + depth_tile_size, width), y1 = std::min(y0 + depth_tile_size, height);
+			min_depth = std::numeric_limits<decimal>::max();
+			for (int j = y0; j < y1; j ++)
+				for (int i = x0; i < x1; i ++)
+					min_depth = std::min(min_depth, depth_buffer.get()[j * width + i]);
+			depth_tile_dirty.get()[tile] = false;
+		}
+		return min_depth;
+	}
+
 	decimal& depth_at(int x, int y) {
 		if (x < 0 || x >= width) throw std::out_of_range("out of range");
 		if (y < 0 || y >= height) throw std::out_of_range("out of range");
@@ -1,3 +1,49 @@
 #include "gpu.h"
+#include "command_buffer.h"
+#include "draw_queue.h"
 
-GPU* GPU::instance = nullptr;
\ No newline at end of file
+GPU* GPU::instance = nullptr;
+
+void GPU::submit(const Command_buffer& commands) {
+	for (auto &command : commands.get_commands()) {
+		std::visit([this](auto &&recorded) {
+			using T = std::decay_t<decltype(recorded)>;
+			if constexpr (std::is_same_v<T, Command_buffer::Bind>) {
+				bind(recorded.object, recorded.id);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Set_buffer>) {
+				set_buffer(recorded.object, recorded.data.data(), recorded.size);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Set_vertex_array>) {
+				set_vertex_array(recorded.vao);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Set_shader>) {
+				shader = recorded.create();
+			} else if constexpr (std::is_same_v<T, Command_buffer::Update_shader>) {
+				if (!shader) throw std::invalid_argument("no shader bound");
+				recorded.update(*shader);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Set_state>) {
+				recorded.apply(*this);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Clear>) {
+				clear();
+			} else if constexpr (std::is_same_v<T, Command_buffer::Draw>) {
+				draw_primitive(recorded.primitive);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Set_instance_array>) {
+				set_instance_array(recorded.vao);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Draw_instanced>) {
+				draw_primitive_instanced(recorded.primitive, recorded.instance_count);
+			} else if constexpr (std::is_same_v<T, Command_buffer::Draw_indirect>) {
+				multi_draw_indirect(recorded.primitive, recorded.draw_count, recorded.first_draw);
+			}
+		}, command);
+	}
+}
+
+void GPU::submit(const std::vector<std::reference_wrapper<const Command_buffer>>& command_buffers) {
+	for (auto &commands : command_buffers) submit(commands.get());
+}
+
+void GPU::submit(const Draw_queue& queue) {
+	if (!sorted_submission) {
+		for (int i = 0; i < queue.size(); i ++) submit(queue.at(i));
+		return;
+	}
+	for (int i : queue.sorted_order()) submit(queue.at(i));
+}
\ No newline at end of file
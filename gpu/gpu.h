@@ -5,6 +5,11 @@
 #include "frame_buffer.h"
 #include "buffer_object.h"
 #include "shader.h"
+#include "vertex_cache.h"
+#include "vertex_streams.h"
+#include "thread_pool.h"
+#include "pipeline_statistics.h"
+#include "profiler.h"
 #include "raster.h"
 #include "camera.h"
 
@@ -13,12 +18,15 @@
 enum OBJECT {
 	VERTEX_ARRAY,
 	VERTEX_BUFFER,
-	ELEMENT_BUFFER
+	ELEMENT_BUFFER,
+	DRAW_INDIRECT_BUFFER,
+	QUERY
 };
 
 enum PRIMITIVE {
 	TRIANGLE,
 	LINE,
+	POINT
 };
 
 enum CULL_TYPE {
@@ -27,58 +35,348 @@ enum CULL_TYPE {
 	DISABLE
 };
 
+enum PIPELINE_MODE {
+	IMMEDIATE,
+	BINNED,
+	STREAMING
+};
+
+class Command_buffer;
+class Draw_queue;
+
+enum RASTER_MODE {
+	FLOATING_POINT,
+	FIXED_POINT
+};
+
 class GPU
 {
 private:
     static GPU* instance;
 
-	std::unique_ptr<Frame_buffer> frame_buffer{ nullptr };
+	std::shared_ptr<Frame_buffer> frame_buffer{ nullptr };
 
 	std::unordered_map<int, VAO> vao_map{};
 	std::unordered_map<int, VBO> vbo_map{};
 	std::unordered_map<int, EBO> ebo_map{};
-	int vbo_count{ 0 }, vao_count{ 0 }, ebo_count{ 0 };
-	int vbo_id{ 0 }, vao_id{ 0 }, ebo_id{ 0 };
+	std::unordered_map<int, Buffer_object<int>> indirect_map{};
+	int vbo_count{ 0 }, vao_count{ 0 }, ebo_count{ 0 }, indirect_count{ 0 };
+	int vbo_id{ 0 }, vao_id{ 0 }, ebo_id{ 0 }, indirect_id{ 0 };
 
 	std::unique_ptr<Shader> shader{ nullptr };
 
-	GPU() = default;
+	std::vector<std::vector<int>> tile_bins{};
 
-	void vertex_shade(std::vector<Vertex_shader_data>& output) {
+	std::unique_ptr<Thread_pool> pool{ nullptr };
 
-		output.clear();
-		
+	VAO instance_vao{};
+
+	std::unordered_map<int, Pipeline_statistics> query_map{};
+	int query_count{ 0 }, active_query{ 0 };
+	std::array<std::atomic<int64_t>, STATISTIC_COUNT> statistics{};
+
+	//stages add their counts once per batch, nothing is counted while no query is active
+	void record(STATISTIC statistic, int64_t n) {
+		if (active_query && n) statistics[statistic] += n;
+	}
+
+	//fragments rejected by the per pixel early depth test never reach the fragment shader
+	void count_early_depth_test(int64_t failed) {
+		record(STATISTIC::FRAGMENTS_RASTERIZED, failed);
+		record(STATISTIC::DEPTH_TEST_FAILED, failed);
+	}
+
+	//created on first use and recreated when thread_count changes
+	Thread_pool& thread_pool() {
+		if (thread_count <= 0) throw std::invalid_argument("invalid thread count");
+		if (!pool || pool->size() != thread_count) pool = std::make_unique<Thread_pool>(thread_count);
+		return *pool;
+	}
+
+	//position, color and uv streams of the bound attributes, resolved once per draw
+	std::array<Vertex_stream, 3> vertex_streams() {
+		std::array<Vertex_stream, 3> streams;
+		for (int i = 0; i < 3; i ++) {
+			if (!vao_map.contains(i + 1)) throw std::invalid_argument("invalid vao");
+			auto [id, stride, offset, item_size] = vao_map[i + 1];
+			if (!vbo_map.contains(id)) throw std::invalid_argument("invalid vbo");
+			auto& vbo = vbo_map[id];
+			int64_t last = (int64_t)vbo.size_data - offset - item_size;
+			int64_t count = last < 0 ? 0 : stride > 0 ? last / stride + 1 : INT_MAX;
+			streams[i] = {vbo.get_data(), stride, offset, (int)std::min<int64_t>(count, INT_MAX)};
+		}
+		return streams;
+	}
+
+	static Vertex_shader_data fetch_vertex(const std::array<Vertex_stream, 3>& streams, int vertex_id) {
+		auto position_f = math::to_homo_point(math::Point3d{streams[0][vertex_id], 3});
+		auto color_f = math::Color_decimal(streams[1][vertex_id], 4);
+		auto uv_f = math::UV(streams[2][vertex_id], 2);
+		return {position_f, color_f, uv_f, 1.0};
+	}
+
+	//index range of the bound ebo drawn by one draw, base_vertex is added to every index
+	struct Draw_range {
+		int first_index{ 0 }, count{ 0 }, base_vertex{ 0 };
+	};
+
+	//the index range has to lie inside the bound ebo and every vertex id inside all attribute streams
+	Draw_range validate(const Draw_range& range, const std::array<Vertex_stream, 3>& streams) {
+		auto& ebo = bound_ebo();
+		if (range.first_index < 0 || range.count < 0 || range.count > ebo.size_data - range.first_index) throw std::out_of_range("invalid index range");
+		int vertex_count = std::min({streams[0].count, streams[1].count, streams[2].count});
+		auto indices = ebo.get_data() + range.first_index;
+		for (int i = 0; i < range.count; i ++) {
+			int64_t vertex_id = (int64_t)indices[i] + range.base_vertex;
+			if (vertex_id < 0 || vertex_id >= vertex_count) throw std::out_of_range("invalid vertex id");
+		}
+		return range;
+	}
+
+	//reused by every draw, the staged pipeline allocates only when a draw outgrows them
+	struct Stage_buffers {
+		std::vector<int> slots{}, vertex_ids{}, vertex_indices{};
+		std::vector<Vertex_shader_data> vertex_fetch_output{};
+		std::vector<Vertex_shader_data> vertex_shade_output{};
+		//shaded vertices followed by the vertices made by clipping, triangle_indices refer to them
+		Vertex_streams vertex_streams{};
+		std::vector<int> outcodes{}, triangle_indices{};
+		std::vector<Vertex_shader_data> clipped{};
+		std::vector<Vertex_shader_data> rasterizing_output{};
+		std::vector<Fragment_shader_data> fragment_shade_output{};
+		std::vector<char> point_visible{};
+		//point bins per chunk of the point list and tile, a tile walks the chunks in order
+		std::vector<std::vector<std::vector<int>>> point_bins{};
+	} buffers{};
+
+	EBO& bound_ebo() {
 		if (!ebo_map.contains(ebo_id)) {
 			throw std::invalid_argument("invalid ebo");
 		}
+		return ebo_map[ebo_id];
+	}
+
+	//every distinct vertex id is fetched once, output_indices refer to the slots in output.
+	//slots are assigned serially in index order and filled in parallel chunks, each slot is
+	//written by one worker only, so the result does not depend on the thread count
+	//the range was validated, so the slots span at most the vertices of the vbo
+	void vertex_fetch(std::vector<Vertex_shader_data>& output, std::vector<int>& output_indices, const Draw_range& range, const std::array<Vertex_stream, 3>& streams) {
+		TRACE_SCOPE("vertex_fetch");
+
+		output.clear();
+		output_indices.clear();
+		if (!range.count) return;
 		
-		auto& ebo = ebo_map[ebo_id];
-		auto indices = ebo.get_buffer_data(0, 3, 0, ebo.size_data);
+		auto indices = bound_ebo().get_data() + range.first_index;
 
-		for (int i = 0; i < ebo.size_data; i ++) {
-			int vertex_id = indices[i];
+		int min_id = INT_MAX, max_id = INT_MIN;
+		for (int i = 0; i < range.count; i ++) {
+			int vertex_id = indices[i] + range.base_vertex;
+			min_id = std::min(min_id, vertex_id);
+			max_id = std::max(max_id, vertex_id);
+		}
+
+		auto& slots = buffers.slots;
+		slots.assign(max_id - min_id + 1, -1);
+		auto& vertex_ids = buffers.vertex_ids;
+		vertex_ids.clear();
+		output_indices.reserve(range.count);
+
+		for (int i = 0; i < range.count; i ++) {
+			int vertex_id = indices[i] + range.base_vertex;
+			int& slot = slots[vertex_id - min_id];
+			if (slot == -1) {
+				slot = vertex_ids.size();
+				vertex_ids.push_back(vertex_id);
+			}
+			output_indices.push_back(slot);
+		}
 
-			//position
-			auto [id0, stride0, offset0, item_size0] = vao_map[1];
-			auto position = vbo_map[id0].get_buffer_data(vertex_id, stride0, offset0, item_size0);
-			auto position_f = math::to_homo_point(math::Point3d{position.get(), 3});
+		output.resize(vertex_ids.size());
+		parallel_chunks((int)vertex_ids.size(), vertex_chunk_size, [&](int i) {
+			output[i] = fetch_vertex(streams, vertex_ids[i]);
+		});
+		record(STATISTIC::VERTICES_FETCHED, (int64_t)vertex_ids.size());
+	}
 
-			//color
-			auto [id1, stride1, offset1, item_size1] = vao_map[2];
-			auto color = vbo_map[id1].get_buffer_data(vertex_id, stride1, offset1, item_size1);
-			auto color_f = math::Color_decimal(color.get(), 4);
-			
-			//uv
-			auto [id2, stride2, offset2, item_size2] = vao_map[3];
-			auto uv = vbo_map[id2].get_buffer_data(vertex_id, stride2, offset2, item_size2);
-			auto uv_f = math::UV(uv.get(), 2);
+	//the pipeline stages below take the type of the bound shader, T is either Shader, which calls
+	//through the vtable, or the exact type of the bound shader, whose members are called directly
+	template<typename T>
+	T& bound_shader() {
+		return static_cast<T&>(*shader);
+	}
 
-			auto vs_output = shader.get()->vertex_shader({position_f, color_f, uv_f, 1.0});
-			output.push_back(std::move(vs_output));
+	template<typename T>
+	static Vertex_shader_data shade_vertex(T& shader_, const Vertex_shader_data& input) {
+		if constexpr (std::is_same_v<T, Shader>) return shader_.vertex_shader(input);
+		else return shader_.T::vertex_shader(input);
+	}
+
+	//a T that keeps the default fragment_shader_batch gets its scalar fragment_shader inlined into the loop
+	template<typename T>
+	static void shade_fragments(T& shader_, std::span<const Vertex_shader_data> input, std::span<Fragment_shader_data> output) {
+		using Default_batch = void (Shader::*)(std::span<const Vertex_shader_data>, std::span<Fragment_shader_data>);
+		if constexpr (std::is_same_v<T, Shader>) {
+			shader_.fragment_shader_batch(input, output);
+		} else if constexpr (std::is_same_v<decltype(&T::fragment_shader_batch), Default_batch>) {
+			for (size_t i = 0; i < input.size(); i ++) output[i] = shader_.T::fragment_shader(input[i]);
+		} else {
+			shader_.T::fragment_shader_batch(input, output);
 		}
 	}
+
+	template<typename T = Shader>
+	void vertex_shade(std::vector<Vertex_shader_data>& output, const std::vector<Vertex_shader_data>& input) {
+		TRACE_SCOPE("vertex_shade");
+		output.resize(input.size());
+		auto& shader_ = bound_shader<T>();
+		parallel_chunks((int)input.size(), vertex_chunk_size, [&](int i) {
+			output[i] = shade_vertex(shader_, input[i]);
+		});
+		record(STATISTIC::VERTEX_SHADER_INVOCATIONS, (int64_t)input.size());
+	}
+
+	//shader outputs are scattered into one array per component
+	template<typename T = Shader>
+	void vertex_shade(Vertex_streams& output, const std::vector<Vertex_shader_data>& input) {
+		TRACE_SCOPE("vertex_shade");
+		output.resize((int)input.size());
+		auto& shader_ = bound_shader<T>();
+		parallel_chunks((int)input.size(), vertex_chunk_size, [&](int i) {
+			output.set(i, shade_vertex(shader_, input[i]));
+		});
+		record(STATISTIC::VERTEX_SHADER_INVOCATIONS, (int64_t)input.size());
+	}
+
+	//calls f(i) for every i in [0, count), chunk_size consecutive items per task
+	template<typename F>
+	void parallel_chunks(int count, int chunk_size, F&& f) {
+		if (chunk_size <= 0) throw std::invalid_argument("invalid chunk size");
+		int chunks = (count + chunk_size - 1) / chunk_size;
+		thread_pool().parallel_for(chunks, [&](int chunk, int) {
+			int end = std::min((chunk + 1) * chunk_size, count);
+			for (int i = chunk * chunk_size; i < end; i ++) f(i);
+		});
+	}
+
+	//per-instance attributes of an instanced draw, resolved once per draw
+	struct Instance_stream {
+		Vertex_stream stream{};
+		int item_size{ 0 };
+	};
+
+	Instance_stream instance_stream(int instance_count) {
+		auto [id, stride, offset, item_size] = instance_vao;
+		if (item_size <= 0) return {};
+		if (!vbo_map.contains(id)) throw std::invalid_argument("invalid vbo");
+		auto& vbo = vbo_map[id];
+		if (instance_count > 0 && offset + (instance_count - 1) * stride + item_size > vbo.size_data) throw std::out_of_range("instance stream too short");
+		return {{vbo.get_data(), stride, offset}, item_size};
+	}
+
+	void bind_instance(const Instance_stream& instances, int instance_id) {
+		shader.get()->bind_instance(instance_id, instances.item_size ? instances.stream[instance_id] : nullptr, instances.item_size);
+	}
+
+	template<typename T = Shader>
+	const Vertex_shader_data& vertex_shade(Vertex_cache& cache, const std::array<Vertex_stream, 3>& streams, int vertex_id) {
+		if (auto cached = cache.find(vertex_id)) return *cached;
+		record(STATISTIC::VERTICES_FETCHED, 1);
+		record(STATISTIC::VERTEX_SHADER_INVOCATIONS, 1);
+		return cache.insert(vertex_id, shade_vertex(bound_shader<T>(), fetch_vertex(streams, vertex_id)));
+	}
 	
-	void clip_cull(std::vector<Vertex_shader_data>& output, std::vector<Vertex_shader_data>& input) {
+	//bits of an outcode, one per clip plane
+	static constexpr int frustum_planes = 0b000'0111'1111;
+	static constexpr int depth_planes = 0b000'0110'0001;
+	static constexpr int guard_band_planes = 0b111'1000'0000;
+	static constexpr int clip_plane_count = 11;
+
+	//a point p is inside plane i when clip_plane(i).dot(p) >= 0
+	//0: w, 1 - 4: x and y, 5 - 6: z, 7 - 10: x and y widened by the guard band
+	math::Vector4d clip_plane(int i) {
+		decimal g = std::max<decimal>(guard_band, 1.0);
+		switch (i) {
+			case 0: return {0.0, 0.0, 0.0, -1.0};
+			case 1: return {-1.0, 0.0, 0.0, -1.0};
+			case 2: return {1.0, 0.0, 0.0, -1.0};
+			case 3: return {0.0, -1.0, 0.0, -1.0};
+			case 4: return {0.0, 1.0, 0.0, -1.0};
+			case 5: return {0.0, 0.0, -1.0, -1.0};
+			case 6: return {0.0, 0.0, 1.0, -1.0};
+			case 7: return {-1.0, 0.0, 0.0, -g};
+			case 8: return {1.0, 0.0, 0.0, -g};
+			case 9: return {0.0, -1.0, 0.0, -g};
+			case 10: return {0.0, 1.0, 0.0, -g};
+			default: throw std::out_of_range("invalid clip plane");
+		}
+	}
+
+	//bit i is set when p lies outside clip plane i
+	int outcode(const math::Homo3d& p) {
+		return outcode(p.x(), p.y(), p.z(), p.w());
+	}
+
+	int outcode(decimal x, decimal y, decimal z, decimal w) {
+		decimal g = std::max<decimal>(guard_band, 1.0);
+		std::array<decimal, clip_plane_count> distances{
+			-w,
+			-x - w, x - w, -y - w, y - w,
+			-z - w, z - w,
+			-x - g * w, x - g * w, -y - g * w, y - g * w
+		};
+		int code = 0;
+		for (int i = 0; i < clip_plane_count; i ++)
+			if (sign(distances[i]) < 0) code |= 1 << i;
+		return code;
+	}
+
+	//whether a triangle with edges ab and bc faces away from the cull type
+	bool culled(const math::Vector2d& ab, const math::Vector2d& bc) {
+		if (cull_type == CULL_TYPE::BACK) return sign(cross(ab, bc)) == -1;
+		if (cull_type == CULL_TYPE::FRONT) return sign(cross(ab, bc)) == 1;
+		return false;
+	}
+
+	//clip one triangle against the view frustum, the result is appended to output as a triangle list.
+	//x and y are only clipped against the guard band, the rasterizer discards pixels outside the screen
+	void clip_cull(
+		std::vector<Vertex_shader_data>& output,
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c
+	) {
+
+		auto ab = cast_dims<2>(b.position) - cast_dims<2>(a.position);
+		auto bc = cast_dims<2>(c.position) - cast_dims<2>(b.position);
+		if (culled(ab, bc)) return record(STATISTIC::TRIANGLES_CULLED, 1);
+
+		record(STATISTIC::CLIPPING_INVOCATIONS, 1);
+		int code_a = outcode(a.position), code_b = outcode(b.position), code_c = outcode(c.position);
+
+		//all vertices outside the same plane
+		if (code_a & code_b & code_c & frustum_planes) return;
+
+		//nothing crosses the w, near and far planes or the guard band
+		int clip_planes = (code_a | code_b | code_c) & (depth_planes | guard_band_planes);
+		if (!clip_planes) {
+			output.push_back(a);
+			output.push_back(b);
+			output.push_back(c);
+			return record(STATISTIC::CLIPPING_PRIMITIVES, 1);
+		}
+
+		clip(output, a, b, c, clip_planes);
+	}
+
+	//clip triangle abc against every plane set in clip_planes
+	void clip(
+		std::vector<Vertex_shader_data>& output,
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		int clip_planes
+	) {
 
 		auto get_intersect = [&](
 				const Vertex_shader_data& u, 
@@ -87,11 +385,11 @@ private:
 		) -> Vertex_shader_data {
 
 			decimal dist_u = normal.dot(u.position), dist_v = normal.dot(v.position);
-			auto factor = math::get_factor(dist_u, dist_v, 0.0);
+			auto factor = math::get_factor<decimal>(dist_u, dist_v, 0.0);
 			auto position = math::calculate_weighed(u.position, v.position, factor);
 			auto color = math::calculate_weighed(u.color, v.color, factor);
 			auto uv = math::calculate_weighed(u.uv, v.uv, factor);
-			auto inv_w = 1.0 / position.w();
+			decimal inv_w = 1.0 / position.w();
 
 			return {position, color, uv, inv_w};
 
@@ -119,119 +417,595 @@ private:
 
 		};
 
-		std::vector<math::Vector4d> normals{
-			{0.0, 0.0, 0.0, -1.0},
-			{-1.0, 0.0, 0.0, -1.0},
-			{1.0, 0.0, 0.0, -1.0},
-			{0.0, -1.0, 0.0, -1.0},
-			{0.0, 1.0, 0.0, -1.0},
-			{0.0, 0.0, -1.0, -1.0},
-			{0.0, 0.0, 1.0, -1.0},
+		std::vector<Vertex_shader_data> result{ a, b, c }, data;
+
+		for (int i = 0; i < clip_plane_count; i ++) {
+			if (!(clip_planes >> i & 1)) continue;
+			auto normal = clip_plane(i);
+			std::swap(data, result);
+			result.clear();
+			for (int j = 0; j < data.size(); j ++) {
+				auto& u = data[j];
+				auto& v = data[(j + 1) % data.size()];
+				clipper(result, u, v, normal);
+			}
+		}
+
+		for (int j = 1; j + 1 < result.size(); j ++ ) {
+			output.push_back(result[0]);
+			output.push_back(result[j]);
+			output.push_back(result[j + 1]);
+		}
+		record(STATISTIC::CLIPPING_PRIMITIVES, std::max((int)result.size() - 2, 0));
+	}
+
+	//clip one line against the view frustum, the result is appended to output as a line list
+	void clip_line(std::vector<Vertex_shader_data>& output, const Vertex_shader_data& a, const Vertex_shader_data& b) {
+		record(STATISTIC::CLIPPING_INVOCATIONS, 1);
+		int code_a = outcode(a.position), code_b = outcode(b.position);
+		if (code_a & code_b & frustum_planes) return;
+
+		//the part of ab inside every crossed plane is [t0, t1]
+		int clip_planes = (code_a | code_b) & frustum_planes;
+		decimal t0 = 0.0, t1 = 1.0;
+		for (int i = 0; i < clip_plane_count; i ++) {
+			if (!(clip_planes >> i & 1)) continue;
+			auto normal = clip_plane(i);
+			decimal dist_a = normal.dot(a.position), dist_b = normal.dot(b.position);
+			decimal t = dist_a / (dist_a - dist_b);
+			if (code_a >> i & 1) t0 = std::max(t0, t);
+			else t1 = std::min(t1, t);
+			if (t0 > t1) return;
+		}
+
+		auto point_at = [&](decimal t) -> Vertex_shader_data {
+			std::pair<decimal, decimal> factor{1.0 - t, t};
+			auto position = math::calculate_weighed(a.position, b.position, factor);
+			auto color = math::calculate_weighed(a.color, b.color, factor);
+			auto uv = math::calculate_weighed(a.uv, b.uv, factor);
+			return {position, color, uv, (decimal)1.0 / position.w()};
 		};
 
-		std::vector<Vertex_shader_data> result;
+		output.push_back(code_a ? point_at(t0) : a);
+		output.push_back(code_b ? point_at(t1) : b);
+		record(STATISTIC::CLIPPING_PRIMITIVES, 1);
+	}
 
-		for (int i = 0; i + 2 < input.size(); i += 3) {
+	//outcodes of every vertex are found in one pass over the positions. Accepted triangles keep their
+	//indices, the vertices made by clipping a triangle are appended to vertices and indexed from output
+	void clip_cull(std::vector<int>& output, Vertex_streams& vertices, const std::vector<int>& indices) {
+		TRACE_SCOPE("clip_cull");
+		auto& outcodes = buffers.outcodes;
+		auto& clipped = buffers.clipped;
+		output.clear();
 
-			std::vector<Vertex_shader_data> primitive{
-				input[i],
-				input[i + 1],
-				input[i + 2]
-			};
+		int size = vertices.size();
+		outcodes.resize(size);
+		const decimal *x = vertices.x.data(), *y = vertices.y.data(), *z = vertices.z.data(), *w = vertices.w.data();
+		for (int i = 0; i < size; i ++) {
+			outcodes[i] = outcode(x[i], y[i], z[i], w[i]);
+		}
 
-			auto ab = cast_dims<2>(input[i + 1].position) - cast_dims<2>(input[i].position);
-			auto bc = cast_dims<2>(input[i + 2].position) - cast_dims<2>(input[i + 1].position);
+		//x and y are read through the vectors, appending clipped vertices may move them
+		auto edge = [&](int u, int v) -> math::Vector2d {
+			return {vertices.x[v] - vertices.x[u], vertices.y[v] - vertices.y[u]};
+		};
 
-			if (cull_type == CULL_TYPE::BACK) {
-				if (sign(cross(ab, bc)) == -1) continue;
-			} else if (cull_type == CULL_TYPE::FRONT) {
-				if (sign(cross(ab, bc)) == 1) continue;
-			}
-			
-			result = primitive;
-
-			for (auto &normal : normals) {
-				std::vector<Vertex_shader_data> data = result;
-				result.clear();
-				for (int j = 0; j < data.size(); j ++) {
-					auto& u = data[j];
-					auto& v = data[(j + 1) % data.size()];
-					clipper(result, u, v, normal);
-				}
+		int64_t culled_count = 0, invocations = 0, accepted = 0;
+		for (int i = 0; i + 2 < indices.size(); i += 3) {
+			int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+			if (culled(edge(a, b), edge(b, c))) {
+				culled_count ++;
+				continue;
 			}
 
-			for (int j = 1; j + 1 < result.size(); j ++ ) {
-				output.push_back(result[0]);
-				output.push_back(result[j]);
-				output.push_back(result[j + 1]);
+			invocations ++;
+			int code_a = outcodes[a], code_b = outcodes[b], code_c = outcodes[c];
+			if (code_a & code_b & code_c & frustum_planes) continue;
+
+			int clip_planes = (code_a | code_b | code_c) & (depth_planes | guard_band_planes);
+			if (!clip_planes) {
+				output.push_back(a);
+				output.push_back(b);
+				output.push_back(c);
+				accepted ++;
+				continue;
 			}
+
+			clipped.clear();
+			clip(clipped, vertices[a], vertices[b], vertices[c], clip_planes);
+			for (auto &vertex : clipped) output.push_back(vertices.push_back(vertex));
 		}
+		record(STATISTIC::TRIANGLES_CULLED, culled_count);
+		record(STATISTIC::CLIPPING_INVOCATIONS, invocations);
+		record(STATISTIC::CLIPPING_PRIMITIVES, accepted);
 	}
 
-	void perspective_division(std::vector<Vertex_shader_data>& output, std::vector<Vertex_shader_data>& input) {
-		output.clear();
-		for (auto &data : input) {
-			data.position = math::normalize_homo_point(data.position);
-			data.color *= data.inv_w;
-			data.uv *= data.inv_w;
+	static void perspective_division(Vertex_shader_data& data) {
+		data.position = math::normalize_homo_point(data.position);
+		data.color *= data.inv_w;
+		data.uv *= data.inv_w;
+	}
+
+	void perspective_division(Vertex_streams& vertices) {
+		TRACE_SCOPE("perspective_division");
+		int size = vertices.size();
+		decimal *x = vertices.x.data(), *y = vertices.y.data(), *z = vertices.z.data(), *w = vertices.w.data();
+		for (int i = 0; i < size; i ++) {
+			decimal w_ = w[i];
+			x[i] /= w_, y[i] /= w_, z[i] /= w_, w[i] = 1.0;
+		}
+
+		const decimal* inv_w = vertices.inv_w.data();
+		for (auto component : {&vertices.r, &vertices.g, &vertices.b, &vertices.a, &vertices.u, &vertices.v}) {
+			decimal* data = component->data();
+			for (int i = 0; i < size; i ++) data[i] *= inv_w[i];
 		}
-		output = std::move(input);
 	}
 
-	void screen_mapping(std::vector<Vertex_shader_data>& output, std::vector<Vertex_shader_data>& input) {
-		output.clear();
-		for (auto &data : input) {
-			data.position = math::screen(width(), height()) * data.position;
+	//only the position arrays are touched, each row of the screen matrix is summed in the order of Mat * Vec
+	void screen_mapping(Vertex_streams& vertices) {
+		TRACE_SCOPE("screen_mapping");
+		auto screen = math::screen(width(), height());
+		int size = vertices.size();
+		decimal *x = vertices.x.data(), *y = vertices.y.data(), *z = vertices.z.data(), *w = vertices.w.data();
+		auto row = [&](int k, decimal x_, decimal y_, decimal z_, decimal w_) {
+			return screen.at(k, 0) * x_ + screen.at(k, 1) * y_ + screen.at(k, 2) * z_ + screen.at(k, 3) * w_;
+		};
+		for (int i = 0; i < size; i ++) {
+			decimal x_ = x[i], y_ = y[i], z_ = z[i], w_ = w[i];
+			x[i] = row(0, x_, y_, z_, w_), y[i] = row(1, x_, y_, z_, w_);
+			z[i] = row(2, x_, y_, z_, w_), w[i] = row(3, x_, y_, z_, w_);
+		}
+	}
+
+	//rejects fragments before shading that the depth test in draw would reject anyway,
+	//the depth buffer only grows while depth testing so an early rejection stays valid
+	struct Early_depth_test {
+		Frame_buffer* frame_buffer{ nullptr };
+		bool enabled{ false };
+		//pixels failing the test are counted here when set, one counter per worker
+		int64_t* failed{ nullptr };
+
+		bool block(const math::Pixel& left_bottom, const math::Pixel& right_top, decimal max_depth) const {
+			return !enabled || max_depth >= frame_buffer->tile_min_depth(left_bottom.x(), left_bottom.y());
 		}
-		output = std::move(input);
+
+		bool pixel(int x, int y, decimal depth) const {
+			if (!enabled || depth >= frame_buffer->depth_at(x, y)) return true;
+			if (failed) (*failed) ++;
+			return false;
+		}
+	};
+
+	static_assert(Raster::block_size == Frame_buffer::depth_tile_size, "raster blocks must match the coarse depth tiles");
+
+	Early_depth_test early_depth_test() {
+		return {frame_buffer.get(), early_depth_test_enabled && depth_test_enabled && !shader.get()->writes_depth()};
 	}
 
-	void rasterizing(std::vector<Vertex_shader_data>& output, std::vector<Vertex_shader_data>& input) {
+	template<typename F>
+	void rasterize(const Vertex_shader_data& a, const Vertex_shader_data& b, const Vertex_shader_data& c, const std::pair<math::Pixel, math::Pixel>& bounds, F&& emit, const Early_depth_test& depth_test) {
+		if (raster_mode == RASTER_MODE::FIXED_POINT) Raster::triangle_shader_data_fixed(a, b, c, MSAA, bounds, emit, depth_test);
+		else Raster::triangle_shader_data(a, b, c, MSAA, bounds, emit, depth_test);
+	}
+
+	void rasterizing(std::vector<Vertex_shader_data>& output, const Vertex_streams& vertices, const std::vector<int>& indices) {
+		TRACE_SCOPE("rasterizing");
 		output.clear();
-		for (int i = 0; i < input.size(); i += 3) {
-			std::vector<Vertex_shader_data> result;
-			Raster::triangle_shader_data(result, input[i], input[i + 1], input[i + 2], MSAA);
-			for (auto &data : result) {
-				output.push_back(data);
-			}
+		auto bounds = screen_bounds();
+		int64_t early_failed = 0;
+		auto depth_test = early_depth_test();
+		depth_test.failed = &early_failed;
+		for (int i = 0; i + 2 < indices.size(); i += 3) {
+			rasterize(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]], bounds, [&](const Vertex_shader_data& fragment) {
+				output.push_back(fragment);
+			}, depth_test);
 		}
+		count_early_depth_test(early_failed);
 	}
 
+	template<typename T = Shader>
 	void fragment_shade(std::vector<Fragment_shader_data>& output, std::vector<Vertex_shader_data>& input) {
-		output.clear();
-		for (auto &data : input) {
-			output.push_back(shader.get()->fragment_shader(data));
+		TRACE_SCOPE("fragment_shade");
+		output.resize(input.size());
+		shade_fragments(bound_shader<T>(), input, output);
+		record(STATISTIC::FRAGMENTS_RASTERIZED, (int64_t)input.size());
+		record(STATISTIC::FRAGMENTS_SHADED, (int64_t)input.size());
+	}
+
+	//false when the fragment fails the depth test
+	bool draw(const Fragment_shader_data& data) {
+		auto x = data.pixel.x(), y = data.pixel.y();
+		auto depth = data.depth;
+		if (depth_test_enabled) {
+			if (depth >= frame_buffer.get()->depth_at(x, y)) {
+				if (depth_update_enabled) frame_buffer.get()->set_depth(x, y, depth);
+				set_pixel(x, y, data.color, blend_enabled);
+				return true;
+			}
+			return false;
 		}
+		set_pixel(x, y, data.color, blend_enabled);
+		return true;
 	}
 
 	void draw(std::vector<Fragment_shader_data>& input) {
+		TRACE_SCOPE("draw");
+		int64_t failed = 0;
 		for (auto &data : input) {
-			auto x = data.pixel.x(), y = data.pixel.y();
-			auto depth = data.depth;
-			if (depth_test_enabled) {
-				if (depth >= frame_buffer.get()->depth_at(x, y)) {
-					if (depth_update_enabled) frame_buffer.get()->depth_at(x, y) = depth;
-					set_pixel(x, y, data.color, blend_enabled);
+			if (!draw(data)) failed ++;
+		}
+		record(STATISTIC::DEPTH_TEST_FAILED, failed);
+	}
+
+	//bins are aligned to the coarse depth tiles so that no two workers share one
+	int bin_size() {
+		return (tile_size + Frame_buffer::depth_tile_size - 1) / Frame_buffer::depth_tile_size * Frame_buffer::depth_tile_size;
+	}
+
+	//sort screen mapped triangles into tile bins, keeping submission order inside every bin
+	void binning(const Vertex_streams& vertices, const std::vector<int>& indices, int tiles_x, int tiles_y) {
+		TRACE_SCOPE("binning");
+		tile_bins.resize(tiles_x * tiles_y);
+		for (auto &bin : tile_bins) bin.clear();
+
+		auto point = [&](int vertex) -> math::Point2d { return {vertices.x[vertex], vertices.y[vertex]}; };
+		for (int i = 0; i + 2 < indices.size(); i += 3) {
+			math::Triangle2d triangle(point(indices[i]), point(indices[i + 1]), point(indices[i + 2]));
+			auto [left_bottom, right_top] = triangle.bounding_box();
+			int min_x = left_bottom.x(), min_y = left_bottom.y();
+			int max_x = right_top.x(), max_y = right_top.y();
+			clamp(min_x, 0, width() - 1), clamp(max_x, 0, width() - 1);
+			clamp(min_y, 0, height() - 1), clamp(max_y, 0, height() - 1);
+
+			for (int ty = min_y / bin_size(); ty <= max_y / bin_size(); ty ++)
+				for (int tx = min_x / bin_size(); tx <= max_x / bin_size(); tx ++)
+					tile_bins[ty * tiles_x + tx].push_back(i);
+		}
+	}
+
+	//every tile is rasterized, shaded and depth tested by exactly one worker,
+	//so workers never touch the same pixels of the color and depth buffer
+	template<typename T = Shader>
+	void tile_rendering(const Vertex_streams& vertices, const std::vector<int>& indices, int tiles_x, int tiles_y) {
+		TRACE_SCOPE("tile_rendering");
+		auto depth_test = early_depth_test();
+		auto& workers = thread_pool();
+		std::vector<std::vector<Vertex_shader_data>> worker_fragments(workers.size());
+		std::vector<std::vector<Fragment_shader_data>> worker_shaded(workers.size());
+
+		workers.parallel_for(tiles_x * tiles_y, [&](int tile, int worker) {
+			TRACE_SCOPE("tile");
+			auto& bin = tile_bins[tile];
+			if (bin.empty()) return;
+			auto& fragments = worker_fragments[worker];
+			auto& shaded = worker_shaded[worker];
+
+			auto [left_bottom, right_top] = tile_bounds(tile, tiles_x);
+			int64_t early_failed = 0;
+			auto tile_depth_test = depth_test;
+			tile_depth_test.failed = &early_failed;
+
+			//fragments of one triangle are written before the next one is tested against the depth buffer
+			for (int i : bin) {
+				rasterize(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]], {left_bottom, right_top}, [&](const Vertex_shader_data& fragment) {
+					fragments.push_back(fragment);
+				}, tile_depth_test);
+				fragment_shade_draw<T>(fragments, shaded);
+			}
+			count_early_depth_test(early_failed);
+		});
+	}
+
+	std::pair<math::Pixel, math::Pixel> tile_bounds(int tile, int tiles_x) {
+		int size = bin_size();
+		int min_x = (tile % tiles_x) * size, min_y = (tile / tiles_x) * size;
+		return {{min_x, min_y}, {std::min(min_x + size, width()) - 1, std::min(min_y + size, height()) - 1}};
+	}
+
+	std::pair<math::Pixel, math::Pixel> screen_bounds() {
+		return {{0, 0}, {width() - 1, height() - 1}};
+	}
+
+	//shade a batch of fragments with one call to the shader and write it to the frame buffer,
+	//shaded is scratch space of the calling worker
+	template<typename T = Shader>
+	void fragment_shade_draw(std::vector<Vertex_shader_data>& fragments, std::vector<Fragment_shader_data>& shaded) {
+		shaded.resize(fragments.size());
+		shade_fragments(bound_shader<T>(), fragments, shaded);
+		int64_t failed = 0;
+		for (auto &data : shaded) {
+			if (!draw(data)) failed ++;
+		}
+		record(STATISTIC::FRAGMENTS_RASTERIZED, (int64_t)fragments.size());
+		record(STATISTIC::FRAGMENTS_SHADED, (int64_t)fragments.size());
+		record(STATISTIC::DEPTH_TEST_FAILED, failed);
+		fragments.clear();
+	}
+
+	//push every primitive straight through clip, setup, raster, shade and ROP,
+	//only one primitive and one fragment batch are alive at a time
+	template<typename T = Shader>
+	void draw_triangle_streaming(const Draw_range& range, int instance_count, const Instance_stream* instances, const std::array<Vertex_stream, 3>& streams) {
+		TRACE_SCOPE("draw_triangle_streaming");
+		auto indices = bound_ebo().get_data() + range.first_index;
+		auto screen = math::screen(width(), height());
+		auto bounds = screen_bounds();
+		int64_t early_failed = 0;
+		auto depth_test = early_depth_test();
+		depth_test.failed = &early_failed;
+
+		Vertex_cache vertex_cache(vertex_cache_size);
+		std::vector<Vertex_shader_data> clipped;
+		std::vector<Vertex_shader_data> fragments;
+		std::vector<Fragment_shader_data> shaded;
+		fragments.reserve(fragment_batch_size);
+
+		for (int instance = 0; instance < instance_count; instance ++) {
+			if (instances) {
+				bind_instance(*instances, instance);
+				vertex_cache.clear();
+			}
+
+			for (int i = 0; i + 2 < range.count; i += 3) {
+				//copied out, a later insert may evict an entry of the same triangle
+				auto a = vertex_shade<T>(vertex_cache, streams, indices[i] + range.base_vertex);
+				auto b = vertex_shade<T>(vertex_cache, streams, indices[i + 1] + range.base_vertex);
+				auto c = vertex_shade<T>(vertex_cache, streams, indices[i + 2] + range.base_vertex);
+
+				clipped.clear();
+				clip_cull(clipped, a, b, c);
+
+				for (auto &data : clipped) {
+					perspective_division(data);
+					data.position = screen * data.position;
 				}
-			} else {
-				set_pixel(x, y, data.color, blend_enabled);
+
+				for (int j = 0; j + 2 < clipped.size(); j += 3) {
+					rasterize(clipped[j], clipped[j + 1], clipped[j + 2], bounds, [&](const Vertex_shader_data& fragment) {
+						fragments.push_back(fragment);
+						if (fragments.size() >= fragment_batch_size) fragment_shade_draw<T>(fragments, shaded);
+					}, depth_test);
+				}
+			}
+
+			//the fragment shader may depend on the bound instance
+			fragment_shade_draw<T>(fragments, shaded);
+		}
+		count_early_depth_test(early_failed);
+	}
+
+	//indexed line list, every two indices form a line. vertices are fetched once per draw and
+	//shaded in parallel, lines are clipped and rasterized in order and their fragments shaded in
+	//batches of fragment_batch_size, the same in every pipeline mode
+	template<typename T = Shader>
+	void draw_line(const Draw_range& range, int instance_count, const Instance_stream* instances, const std::array<Vertex_stream, 3>& streams) {
+		TRACE_SCOPE("draw_line");
+		auto screen = math::screen(width(), height());
+		auto bounds = screen_bounds();
+		int64_t early_failed = 0;
+		auto depth_test = early_depth_test();
+		depth_test.failed = &early_failed;
+
+		auto& b = buffers;
+		vertex_fetch(b.vertex_fetch_output, b.vertex_indices, range, streams);
+
+		std::vector<Vertex_shader_data> clipped;
+		std::vector<Vertex_shader_data> fragments;
+		std::vector<Fragment_shader_data> shaded;
+		fragments.reserve(fragment_batch_size);
+
+		for (int instance = 0; instance < instance_count; instance ++) {
+			if (instances) bind_instance(*instances, instance);
+
+			vertex_shade<T>(b.vertex_shade_output, b.vertex_fetch_output);
+
+			for (int i = 0; i + 1 < b.vertex_indices.size(); i += 2) {
+				clipped.clear();
+				clip_line(clipped, b.vertex_shade_output[b.vertex_indices[i]], b.vertex_shade_output[b.vertex_indices[i + 1]]);
+				if (clipped.empty()) continue;
+
+				for (auto &data : clipped) {
+					perspective_division(data);
+					data.position = screen * data.position;
+				}
+
+				Raster::line_shader_data(clipped[0], clipped[1], bounds, [&](const Vertex_shader_data& fragment) {
+					fragments.push_back(fragment);
+					if (fragments.size() >= fragment_batch_size) fragment_shade_draw<T>(fragments, shaded);
+				}, depth_test);
+			}
+
+			fragment_shade_draw<T>(fragments, shaded);
+		}
+		count_early_depth_test(early_failed);
+	}
+
+	//pixels covered by a point of point_size pixels centered at its screen position
+	std::pair<math::Pixel, math::Pixel> splat_bounds(const Vertex_shader_data& point) {
+		int min_x = (int)std::floor(point.position.x() - point_size * 0.5 + 0.5);
+		int min_y = (int)std::floor(point.position.y() - point_size * 0.5 + 0.5);
+		return {{min_x, min_y}, {min_x + point_size - 1, min_y + point_size - 1}};
+	}
+
+	//every index is a point splatted as a square of point_size pixels with the depth and varyings
+	//of its vertex. points are mapped and binned to screen tiles in parallel chunks, then every tile
+	//is splatted by one worker in submission order. single pixel points without blending take a
+	//depth only pass first when the early depth test applies, and shade just the point left in
+	//front of each pixel
+	template<typename T = Shader>
+	void draw_point(const Draw_range& range, int instance_count, const Instance_stream* instances, const std::array<Vertex_stream, 3>& streams) {
+		TRACE_SCOPE("draw_point");
+		if (point_size <= 0) throw std::invalid_argument("invalid point size");
+		if (tile_size <= 0) throw std::invalid_argument("invalid tile size");
+
+		auto screen = math::screen(width(), height());
+		auto depth_test = early_depth_test();
+		int tiles_x = (width() + bin_size() - 1) / bin_size();
+		int tiles_y = (height() + bin_size() - 1) / bin_size();
+		bool depth_only_pass = point_size == 1 && depth_test.enabled && depth_update_enabled && !blend_enabled;
+
+		auto& b = buffers;
+		vertex_fetch(b.vertex_fetch_output, b.vertex_indices, range, streams);
+		auto& workers = thread_pool();
+		std::vector<std::vector<Vertex_shader_data>> worker_fragments(workers.size());
+		std::vector<std::vector<Fragment_shader_data>> worker_shaded(workers.size());
+
+		int count = (int)b.vertex_indices.size();
+		int chunks = std::max(1, std::min(workers.size() * 4, (count + vertex_chunk_size - 1) / vertex_chunk_size));
+		int chunk_size = (count + chunks - 1) / chunks;
+		b.point_bins.resize(chunks);
+		for (auto &bins : b.point_bins) bins.resize(tiles_x * tiles_y);
+
+		for (int instance = 0; instance < instance_count; instance ++) {
+			if (instances) bind_instance(*instances, instance);
+
+			vertex_shade<T>(b.vertex_shade_output, b.vertex_fetch_output);
+
+			//points behind the camera or outside the depth range are dropped, the rest is mapped in place
+			auto& points = b.vertex_shade_output;
+			b.point_visible.assign(points.size(), 0);
+			parallel_chunks((int)points.size(), vertex_chunk_size, [&](int i) {
+				if (outcode(points[i].position) & depth_planes) return;
+				perspective_division(points[i]);
+				points[i].position = screen * points[i].position;
+				b.point_visible[i] = 1;
+			});
+
+			workers.parallel_for(chunks, [&](int chunk, int) {
+				auto& bins = b.point_bins[chunk];
+				for (auto &bin : bins) bin.clear();
+				int end = std::min((chunk + 1) * chunk_size, count);
+				for (int i = chunk * chunk_size; i < end; i ++) {
+					int slot = b.vertex_indices[i];
+					if (!b.point_visible[slot]) continue;
+					auto [left_bottom, right_top] = splat_bounds(points[slot]);
+					int min_x = std::max(left_bottom.x(), 0), max_x = std::min(right_top.x(), width() - 1);
+					int min_y = std::max(left_bottom.y(), 0), max_y = std::min(right_top.y(), height() - 1);
+					if (min_x > max_x || min_y > max_y) continue;
+					for (int ty = min_y / bin_size(); ty <= max_y / bin_size(); ty ++)
+						for (int tx = min_x / bin_size(); tx <= max_x / bin_size(); tx ++)
+							bins[ty * tiles_x + tx].push_back(slot);
+				}
+			});
+
+			workers.parallel_for(tiles_x * tiles_y, [&](int tile, int worker) {
+				TRACE_SCOPE("tile");
+				auto [tile_min, tile_max] = tile_bounds(tile, tiles_x);
+				auto& fragments = worker_fragments[worker];
+				auto& shaded = worker_shaded[worker];
+				int64_t early_failed = 0;
+				auto tile_depth_test = depth_test;
+				tile_depth_test.failed = &early_failed;
+
+				auto splat = [&](const Vertex_shader_data& point, auto&& pixel) {
+					auto [left_bottom, right_top] = splat_bounds(point);
+					for (int y = std::max(left_bottom.y(), tile_min.y()); y <= std::min(right_top.y(), tile_max.y()); y ++)
+						for (int x = std::max(left_bottom.x(), tile_min.x()); x <= std::min(right_top.x(), tile_max.x()); x ++)
+							pixel(x, y);
+				};
+
+				auto emit = [&](const Vertex_shader_data& point, int x, int y) {
+					decimal w = 1.0 / point.inv_w;
+					Vertex_shader_data fragment{{x, y, point.position.z(), 1.0}, point.color, point.uv, point.inv_w};
+					fragment.color *= w;
+					fragment.uv *= w;
+					fragments.push_back(fragment);
+					if (fragments.size() >= fragment_batch_size) fragment_shade_draw<T>(fragments, shaded);
+				};
+
+				if (depth_only_pass) {
+					for (auto &bins : b.point_bins)
+						for (int slot : bins[tile]) {
+							auto& point = points[slot];
+							splat(point, [&](int x, int y) {
+								if (point.position.z() >= frame_buffer->depth_at(x, y)) frame_buffer->set_depth(x, y, point.position.z());
+							});
+						}
+					for (auto &bins : b.point_bins)
+						for (int slot : bins[tile]) {
+							auto& point = points[slot];
+							splat(point, [&](int x, int y) {
+								if (point.position.z() == frame_buffer->depth_at(x, y)) emit(point, x, y);
+								else early_failed ++;
+							});
+						}
+				} else {
+					for (auto &bins : b.point_bins)
+						for (int slot : bins[tile]) {
+							auto& point = points[slot];
+							splat(point, [&](int x, int y) {
+								if (tile_depth_test.pixel(x, y, point.position.z())) emit(point, x, y);
+							});
+						}
+				}
+
+				fragment_shade_draw<T>(fragments, shaded);
+				count_early_depth_test(early_failed);
+			});
+		}
+	}
+
+	template<typename T = Shader>
+	void draw(PRIMITIVE primitive, const Draw_range& range, int instance_count, const Instance_stream* instances, const std::array<Vertex_stream, 3>& streams) {
+		if (fragment_batch_size <= 0) throw std::invalid_argument("invalid fragment batch size");
+		if (MSAA < 1 || MSAA > Raster::max_scale) throw std::invalid_argument("invalid MSAA");
+		if (primitive == PRIMITIVE::TRIANGLE) {
+			draw_triangle<T>(range, instance_count, instances, streams);
+		} else if (primitive == PRIMITIVE::LINE) {
+			draw_line<T>(range, instance_count, instances, streams);
+		} else if (primitive == PRIMITIVE::POINT) {
+			draw_point<T>(range, instance_count, instances, streams);
+		}
+		if (instances) shader.get()->unbind_instance();
+	}
+
+	//vertices are fetched once per draw, every instance is shaded and rasterized on its own
+	template<typename T = Shader>
+	void draw_triangle(const Draw_range& range, int instance_count, const Instance_stream* instances, const std::array<Vertex_stream, 3>& streams) {
+		TRACE_SCOPE("draw_triangle");
+		if (pipeline_mode == PIPELINE_MODE::STREAMING) {
+			draw_triangle_streaming<T>(range, instance_count, instances, streams);
+			return;
+		}
+
+		auto& b = buffers;
+		vertex_fetch(b.vertex_fetch_output, b.vertex_indices, range, streams);
+
+		for (int instance = 0; instance < instance_count; instance ++) {
+			if (instances) bind_instance(*instances, instance);
+
+			vertex_shade<T>(b.vertex_streams, b.vertex_fetch_output);
+			clip_cull(b.triangle_indices, b.vertex_streams, b.vertex_indices);
+			perspective_division(b.vertex_streams);
+			screen_mapping(b.vertex_streams);
+
+			if (pipeline_mode == PIPELINE_MODE::BINNED) {
+				if (tile_size <= 0) throw std::invalid_argument("invalid tile size");
+				int tiles_x = (width() + bin_size() - 1) / bin_size();
+				int tiles_y = (height() + bin_size() - 1) / bin_size();
+				binning(b.vertex_streams, b.triangle_indices, tiles_x, tiles_y);
+				tile_rendering<T>(b.vertex_streams, b.triangle_indices, tiles_x, tiles_y);
+				continue;
 			}
-			
+
+			rasterizing(b.rasterizing_output, b.vertex_streams, b.triangle_indices);
+			fragment_shade<T>(b.fragment_shade_output, b.rasterizing_output);
+			draw(b.fragment_shade_output);
 		}
 	}
 
-	void draw_line() {
-		throw std::invalid_argument("not implemented");
+	template<typename T>
+	void check_shader_type() {
+		if (!shader || typeid(*shader) != typeid(T)) throw std::invalid_argument("shader type mismatch");
 	}
 
-	void draw_triangle() {
-		std::vector<Vertex_shader_data> vertex_shade_output; vertex_shade(vertex_shade_output);
-		std::vector<Vertex_shader_data> clip_cull_output; clip_cull(clip_cull_output, vertex_shade_output);
-		std::vector<Vertex_shader_data> perspective_division_output; perspective_division(perspective_division_output, clip_cull_output);
-		std::vector<Vertex_shader_data> screen_mapping_output; screen_mapping(screen_mapping_output, perspective_division_output);
-		std::vector<Vertex_shader_data> rasterizing_output; rasterizing(rasterizing_output, screen_mapping_output);
-		std::vector<Fragment_shader_data> fragment_shade_output; fragment_shade(fragment_shade_output, rasterizing_output);
-		draw(fragment_shade_output);
+	Buffer_object<int>& bound_indirect_buffer() {
+		if (!indirect_map.contains(indirect_id)) {
+			throw std::invalid_argument("invalid draw indirect buffer");
+		}
+		return indirect_map[indirect_id];
 	}
 
 public:
@@ -239,12 +1013,47 @@ public:
 	//vertices arranged clockwise represent front face
 	CULL_TYPE cull_type = CULL_TYPE::DISABLE;
 	PRIMITIVE primitive_type = PRIMITIVE::TRIANGLE;
+	PIPELINE_MODE pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	//fixed point snaps vertices to 1/256 pixel and fills shared edges exactly once (top-left rule)
+	RASTER_MODE raster_mode = RASTER_MODE::FLOATING_POINT;
 
+	//samples per pixel along each axis, 1 to Raster::max_scale
 	int MSAA = 1;
 	bool blend_enabled = true;
 	bool depth_test_enabled = true;
 	bool depth_update_enabled = true;
+	bool early_depth_test_enabled = true;
+	//draw queues run opaque draws front to back grouped by state, then blended draws back to front
+	bool sorted_submission = false;
+
+	//triangles are clipped against x and y only once they leave the screen by this factor
+	decimal guard_band = 4.0;
+
+	//workers of the parallel stages including the calling thread, vertex shader and fragment shader
+	//of the bound shader are called concurrently when greater than 1
+	int thread_count = std::max(1, (int)std::thread::hardware_concurrency());
+	//vertices shaded by one task of the vertex stage
+	int vertex_chunk_size = 256;
+
+	//binned pipeline: edge length of a screen tile, rounded up to the coarse depth tiles
+	int tile_size = 64;
 
+	//edge length in pixels of the square splatted for every point
+	int point_size = 1;
+
+	//streaming pipeline, lines and points: number of fragments shaded and written together
+	int fragment_batch_size = 256;
+	//streaming pipeline: entries of the post-transform cache
+	int vertex_cache_size = 32;
+
+	//an independent context owning its objects, frame buffer, shader, state and worker threads.
+	//separate contexts can be used from separate threads at once, a context from one thread at a time
+	GPU() = default;
+
+	GPU(const GPU&) = delete;
+	GPU& operator=(const GPU&) = delete;
+
+	//the context used through the gpu macro
     static GPU* get_instance() {
         if (instance == nullptr) {
             instance = new GPU();
@@ -253,16 +1062,25 @@ public:
     }
 
 	void init(int width, int height) {
-		frame_buffer = std::make_unique<Frame_buffer>(width, height);
+		frame_buffer = std::make_shared<Frame_buffer>(width, height);
+	}
+
+	//renders into frame_buffer from now on, such as the back buffer of a Swap_chain
+	void set_frame_buffer(std::shared_ptr<Frame_buffer> frame_buffer_) {
+		if (!frame_buffer_) throw std::invalid_argument("invalid frame buffer");
+		frame_buffer = std::move(frame_buffer_);
 	}
 
+	[[nodiscard]] const std::shared_ptr<Frame_buffer>& get_frame_buffer() const { return frame_buffer; }
+
 	int height() { return frame_buffer->height; }
 	int width() { return frame_buffer->width; }
 
     void clear() { frame_buffer->clear(); }
 
+	//shares ownership of the current frame buffer, so it stays valid after set_frame_buffer
 	std::shared_ptr<u_int8_t[]> color_buffer() {
-		return { reinterpret_cast<u_int8_t*>(frame_buffer->color_buffer.get()), [](u_int8_t*) { } };
+		return { frame_buffer->color_buffer, reinterpret_cast<u_int8_t*>(frame_buffer->color_buffer.get()) };
 	}
 
     //the color format of opencv is BGR
@@ -290,6 +1108,12 @@ public:
 		} else if (object == OBJECT::ELEMENT_BUFFER) {
 			ebo_map.insert({++ ebo_count, EBO{}});
 			return ebo_count;
+		} else if (object == OBJECT::DRAW_INDIRECT_BUFFER) {
+			indirect_map.insert({++ indirect_count, Buffer_object<int>{}});
+			return indirect_count;
+		} else if (object == OBJECT::QUERY) {
+			query_map.insert({++ query_count, Pipeline_statistics{}});
+			return query_count;
 		}
 		return 0;
 	}
@@ -301,6 +1125,8 @@ public:
 			vbo_id = id;
 		} else if (object == OBJECT::ELEMENT_BUFFER) {
 			ebo_id = id;
+		} else if (object == OBJECT::DRAW_INDIRECT_BUFFER) {
+			indirect_id = id;
 		}
 	}
 
@@ -308,10 +1134,13 @@ public:
 	void set_buffer(OBJECT object, T* data, int size) {
 		if (object == OBJECT::VERTEX_BUFFER) {
 			if (!vbo_map.contains(vbo_id)) throw std::invalid_argument("invalid id");
-			vbo_map[vbo_id].set_buffer_data(reinterpret_cast<void*>(data), size);
+			vbo_map[vbo_id].set_buffer_data(reinterpret_cast<const void*>(data), size);
 		} else if (object == OBJECT::ELEMENT_BUFFER) {
 			if (!ebo_map.contains(ebo_id)) throw std::invalid_argument("invalid id");
-			ebo_map[ebo_id].set_buffer_data(reinterpret_cast<void*>(data), size);
+			ebo_map[ebo_id].set_buffer_data(reinterpret_cast<const void*>(data), size);
+		} else if (object == OBJECT::DRAW_INDIRECT_BUFFER) {
+			if (!indirect_map.contains(indirect_id)) throw std::invalid_argument("invalid id");
+			indirect_map[indirect_id].set_buffer_data(reinterpret_cast<const void*>(data), size);
 		}
 	}
 
@@ -326,17 +1155,110 @@ public:
 	}
 
 	void draw_primitive(PRIMITIVE primitive) {
-		if (primitive == PRIMITIVE::TRIANGLE) {
-			draw_triangle();
-		} else if (primitive == PRIMITIVE::LINE) {
-			draw_line();
+		auto streams = vertex_streams();
+		draw(primitive, validate({0, bound_ebo().size_data, 0}, streams), 1, nullptr, streams);
+	}
+
+	//same as draw_primitive for a bound shader of exactly type T, its vertex and fragment shaders are
+	//called without virtual dispatch so the compiler can inline them into the pipeline loops
+	template<typename T>
+	void draw_primitive(PRIMITIVE primitive) requires Inherited<Shader, T> {
+		check_shader_type<T>();
+		auto streams = vertex_streams();
+		draw<T>(primitive, validate({0, bound_ebo().size_data, 0}, streams), 1, nullptr, streams);
+	}
+
+	//per-instance attribute stream of instanced draws, item_size values of the vbo per instance,
+	//an item_size of 0 draws instances without attributes
+	void set_instance_array(const VAO& vao) {
+		instance_vao = vao;
+	}
+
+	//draws the bound mesh instance_count times, the shader is told the instance id and attributes
+	//through Shader::bind_instance before each instance and Shader::unbind_instance after the last
+	void draw_primitive_instanced(PRIMITIVE primitive, int instance_count) {
+		if (instance_count < 0) throw std::invalid_argument("invalid instance count");
+		auto instances = instance_stream(instance_count);
+		auto streams = vertex_streams();
+		draw(primitive, validate({0, bound_ebo().size_data, 0}, streams), instance_count, &instances, streams);
+	}
+
+	template<typename T>
+	void draw_primitive_instanced(PRIMITIVE primitive, int instance_count) requires Inherited<Shader, T> {
+		if (instance_count < 0) throw std::invalid_argument("invalid instance count");
+		check_shader_type<T>();
+		auto instances = instance_stream(instance_count);
+		auto streams = vertex_streams();
+		draw<T>(primitive, validate({0, bound_ebo().size_data, 0}, streams), instance_count, &instances, streams);
+	}
+
+	//runs draw_count records of the bound draw indirect buffer starting at record first_draw.
+	//every record is a Draw_indirect_command on the bound ebo, records are validated and the
+	//attribute and instance streams resolved once for all of them
+	void multi_draw_indirect(PRIMITIVE primitive, int draw_count, int first_draw = 0) {
+		auto& indirect_buffer = bound_indirect_buffer();
+		if (first_draw < 0 || draw_count < 0 || ((int64_t)first_draw + draw_count) * Draw_indirect_command::size > indirect_buffer.size_data) {
+			throw std::out_of_range("invalid draw range");
 		}
+		auto records = indirect_buffer.get_data() + first_draw * Draw_indirect_command::size;
+		auto record = [&](int draw) {
+			auto values = records + draw * Draw_indirect_command::size;
+			return Draw_indirect_command{values[0], values[1], values[2], values[3]};
+		};
+
+		auto streams = vertex_streams();
+		int max_instance_count = 0;
+		for (int i = 0; i < draw_count; i ++) {
+			auto [count, first_index, base_vertex, instance_count] = record(i);
+			if (instance_count < 0) throw std::invalid_argument("invalid instance count");
+			validate({first_index, count, base_vertex}, streams);
+			max_instance_count = std::max(max_instance_count, instance_count);
+		}
+
+		auto instances = instance_stream(max_instance_count);
+		for (int i = 0; i < draw_count; i ++) {
+			auto [count, first_index, base_vertex, instance_count] = record(i);
+			if (!count || !instance_count) continue;
+			draw(primitive, {first_index, count, base_vertex}, instance_count, &instances, streams);
+		}
+	}
+
+	void draw_indirect(PRIMITIVE primitive, int draw = 0) {
+		multi_draw_indirect(primitive, 1, draw);
 	}
 
+	//starts counting pipeline statistics into the query, one query is active at a time
+	void begin_query(int id) {
+		if (active_query) throw std::invalid_argument("query already active");
+		if (!query_map.contains(id)) throw std::invalid_argument("invalid id");
+		for (auto &statistic : statistics) statistic = 0;
+		active_query = id;
+	}
+
+	void end_query() {
+		if (!active_query) throw std::invalid_argument("no active query");
+		auto& result = query_map[active_query];
+		for (int i = 0; i < STATISTIC_COUNT; i ++) result.counts[i] = statistics[i];
+		active_query = 0;
+	}
+
+	[[nodiscard]] Pipeline_statistics query_result(int id) const {
+		if (!query_map.contains(id)) throw std::invalid_argument("invalid id");
+		if (id == active_query) throw std::invalid_argument("query still active");
+		return query_map.at(id);
+	}
+
+	//executes recorded command buffers in order on the calling thread
+	void submit(const Command_buffer& commands);
+	void submit(const std::vector<std::reference_wrapper<const Command_buffer>>& command_buffers);
+	//in queued order, or by sort key when sorted_submission is set
+	void submit(const Draw_queue& queue);
+
 	void print_state() {
 		print(OBJECT::VERTEX_ARRAY);
 		print(OBJECT::VERTEX_BUFFER);
 		print(OBJECT::ELEMENT_BUFFER);
+		print(OBJECT::DRAW_INDIRECT_BUFFER);
 	}
 
 	void print(OBJECT object) {
@@ -355,6 +1277,11 @@ public:
 				std::cout << "ebo_id : " << id << std::endl;
 				std::cout << ebo << std::endl;
 			}
+		} else if (object == OBJECT::DRAW_INDIRECT_BUFFER) {
+			for (auto &[id, indirect_buffer] : indirect_map) {
+				std::cout << "draw_indirect_buffer_id : " << id << std::endl;
+				std::cout << indirect_buffer << std::endl;
+			}
 		}
 	}
 
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "base.h"
+
+enum STATISTIC {
+	VERTICES_FETCHED,
+	VERTEX_SHADER_INVOCATIONS,
+	TRIANGLES_CULLED,
+	CLIPPING_INVOCATIONS,
+	CLIPPING_PRIMITIVES,
+	FRAGMENTS_RASTERIZED,
+	FRAGMENTS_SHADED,
+	DEPTH_TEST_FAILED,
+	STATISTIC_COUNT
+};
+
+// result of a pipeline statistics query, counted over the draws between begin_query and end_query.
+// clipping counts triangles and lines entering the clipper and the primitives it outputs.
+// fragments rasterized are those reaching the per pixel depth test or the fragment shader,
+// blocks rejected as a whole by the coarse depth test are not counted
+struct Pipeline_statistics {
+	std::array<int64_t, STATISTIC_COUNT> counts{};
+
+	int64_t operator[](STATISTIC statistic) const { return counts[statistic]; }
+
+	friend std::ostream& operator<<(std::ostream& os, const Pipeline_statistics& statistics) {
+		const char* names[STATISTIC_COUNT] = {
+			"vertices fetched", "vertex shader invocations", "triangles culled", "clipping invocations",
+			"clipping primitives", "fragments rasterized", "fragments shaded", "depth test failed"
+		};
+		for (int i = 0; i < STATISTIC_COUNT; i ++) {
+			os << names[i] << " : " << statistics.counts[i] << std::endl;
+		}
+		return os;
+	}
+};
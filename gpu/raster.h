@@ -1,362 +1,684 @@
-#pragma once
-
-#include "base.h"
-#include "maths.h"
-#include "image.h"
-
-class Raster {
-public:
-	static void line_bresenham_colored(
-		std::vector<std::pair<math::Pixel, math::Color>>& result,
-		std::pair<math::Pixel, math::Color> pixel_a,
-		std::pair<math::Pixel, math::Color> pixel_b
-	) {
-
-		if (pixel_a.first.x() > pixel_b.first.x()) std::swap(pixel_a, pixel_b);
-
-		if (pixel_a.first == pixel_b.first) {
-			result.push_back({pixel_a.first, math::Color::alpha_blend(pixel_a.second, pixel_b.second)});
-			return;
-		}
-
-		auto &[a, color_a] = pixel_a;
-		auto &[b, color_b] = pixel_b;
-
-		bool down = false, surge = false;
-		result.clear();
-
-		int delta_x = b.x() - a.x();
-		int delta_y = b.y() - a.y();
-
-		if (delta_y < 0) {
-			b.y() = -b.y(), a.y() = -a.y();
-			delta_y = b.y() - a.y();
-			down = true;
-		}
-
-		if (delta_y > delta_x) {
-			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
-			delta_x = b.x() - a.x();
-			delta_y = b.y() - a.y();
-			surge = true;
-		}
-
-		//decimal mid_y = -delta_y * (a.x() + 1) + delta_x * (a.y() + 0.5) + a.x() * b.y() - b.x() * a.y();
-		// f(x) * 2 won't effect its relation between 0;
-		int mid_y = 2 * -delta_y * (a.x() + 1) + delta_x * (2 * a.y() + 1) + 2 * a.x() * b.y() - 2 * b.x() * a.y();
-
-		for (int x = a.x(), y = a.y(); x <= b.x(); x ++) {
-
-			auto red = math::interpolate<int, int>({a.x(), color_a.R()}, {b.x(), color_b.R()}, x);
-			auto green = math::interpolate<int, int>({a.x(), color_a.G()}, {b.x(), color_b.G()}, x);
-			auto blue = math::interpolate<int, int>({a.x(), color_a.B()}, {b.x(), color_b.B()}, x);
-			auto alpha = math::interpolate<int, int>({a.x(), color_a.A()}, {b.x(), color_b.A()}, x);
-			result.push_back({{x, y}, math::Color(red, green, blue, alpha)});
-			
-			if (mid_y < 0) {
-				y ++;
-				mid_y += 2 * (delta_x - delta_y);
-			} else {
-				mid_y -= 2 * delta_y;
-			}
-		}
-
-		if (surge) {
-			for (auto &p : result)
-				std::swap(p.first.x(), p.first.y());
-		}
-
-		if (down) {
-			for (auto &p : result)
-				p.first.y() = -p.first.y();
-		}
-
-	}
-
-	static void line_bresenham(
-		std::vector<math::Pixel>& result,
-		math::Pixel a,
-		math::Pixel b
-	)  {
-
-		if (a.x() > b.x()) std::swap(a, b);
-
-		if (a == b) {
-			result.push_back(a);
-			return;
-		}
-
-		bool down = false, surge = false;
-		result.clear();
-
-		int delta_x = b.x() - a.x();
-		int delta_y = b.y() - a.y();
-
-		if (delta_y < 0) {
-			b.y() = -b.y(), a.y() = -a.y();
-			delta_y = b.y() - a.y();
-			down = true;
-		}
-
-		if (delta_y > delta_x) {
-			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
-			delta_x = b.x() - a.x();
-			delta_y = b.y() - a.y();
-			surge = true;
-		}
-
-		//decimal mid_y = -delta_y * (a.x() + 1) + delta_x * (a.y() + 0.5) + a.x() * b.y() - b.x() * a.y();
-		// f(x) * 2 won't effect its relation between 0;
-		int mid_y = 2 * -delta_y * (a.x() + 1) + delta_x * (2 * a.y() + 1) + 2 * a.x() * b.y() - 2 * b.x() * a.y();
-
-		for (int x = a.x(), y = a.y(); x <= b.x(); x ++) {
-			result.push_back({x, y});
-			if (mid_y < 0) {
-				y ++;
-				mid_y += 2 * (delta_x - delta_y);
-			} else {
-				mid_y -= 2 * delta_y;
-			}
-		}
-
-		if (surge) {
-			for (auto &p : result)
-				std::swap(p.x(), p.y());
-		}
-
-		if (down) {
-			for (auto &p : result)
-				p.y() = -p.y();
-		}
-	}
-
-	static void line_alpha(
-		std::vector<std::pair<math::Pixel, decimal>>& result,
-		math::Pixel a,
-		math::Pixel b
-	)  {
-		
-		if (a.x() > b.x()) std::swap(a, b);
-
-		if (a == b) {
-			result.push_back({a, 1.0f});
-			return;
-		}
-
-		bool down = false, surge = false;
-		result.clear();
-
-		decimal delta_x = b.x() - a.x();
-		decimal delta_y = b.y() - a.y();
-
-		if (delta_y < 0) {
-			b.y() = -b.y(), a.y() = -a.y();
-			delta_y = b.y() - a.y();
-			down = true;
-		}
-
-		if (delta_y > delta_x) {
-			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
-			delta_x = b.x() - a.x();
-			delta_y = b.y() - a.y();
-			surge = true;
-		}
-
-		for (int x = a.x(); x <= b.x(); x ++) {
-			decimal y = ((decimal)delta_y / delta_x) * (x - a.x()) + a.y();
-			auto alpha0 = std::ceil(y) - y;
-			auto alpha1 = y - std::ceil(y - 1);
-			result.push_back({{x, (int)std::floor(y)}, alpha0});
-			result.push_back({{x, (int)std::ceil(y)}, alpha1});
-		}
-
-		if (surge) {
-			for (auto &p : result)
-				std::swap(p.first.x(), p.first.y());
-		}
-
-		if (down) {
-			for (auto &p : result)
-				p.first.y() = -p.first.y();
-		}
-	}
-
-	static void triangle_alpha(
-		std::vector<std::pair<math::Pixel, decimal>>& result,
-		const math::Point2d& a,
-		const math::Point2d& b,
-		const math::Point2d& c,
-		int scale = 1
-	) {
-		result.clear();
-		math::Triangle2d triangle(a, b, c);
-		auto [left_bottom, right_top] = triangle.bounding_box();
-		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
-			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
-				std::vector<math::Point2d> sampled_points;
-				math::sample_pixel(sampled_points, {x, y}, scale);
-				int enclosed = 0;
-				for (auto &p : sampled_points) {
-					if (triangle.enclose(p)) enclosed ++;
-				}
-				auto factor = (decimal)enclosed / sampled_points.size();
-				result.push_back({{x, y}, factor});
-			}
-	}
-
-	static void triangle_colored(
-		std::vector<std::pair<math::Pixel, math::Color>>& result,
-		const std::pair<math::Point2d, math::Color>& a,
-		const std::pair<math::Point2d, math::Color>& b,
-		const std::pair<math::Point2d, math::Color>& c,
-		int scale = 1
-	) {
-		result.clear();
-		auto &[point_a, color_a] = a;
-		auto &[point_b, color_b] = b;
-		auto &[point_c, color_c] = c;
-		math::Triangle2d triangle(point_a, point_b, point_c);
-		auto [left_bottom, right_top] = triangle.bounding_box();
-		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
-			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
-				
-				std::vector<math::Point2d> sampled_points;
-				math::sample_pixel(sampled_points, {x, y}, scale);
-				int enclosed = 0;
-				for (auto &p : sampled_points) {
-					if (triangle.enclose(p)) enclosed ++;
-				}
-
-				auto factor = (decimal)enclosed / (scale * scale);
-				auto barycentric = math::get_factor(point_a, point_b, point_c, {x, y});
-
-				auto color = math::Color::interpolate_color(color_a, color_b, color_c, barycentric);
-				color *= factor;
-
-				result.push_back({{x, y}, color});
-			}
-	}
-
-	static void triangle_textured(
-		std::vector<std::pair<math::Pixel, math::Color>>& result,
-		const std::pair<math::Point2d, math::UV>& a,
-		const std::pair<math::Point2d, math::UV>& b,
-		const std::pair<math::Point2d, math::UV>& c,
-		const Image& image,
-		int scale = 1,
-		bool bilinear = true,
-		WRAP_MODE warp_mode = WRAP_MODE::REPEAT
-	) {
-		result.clear();
-		auto &[point_a, uv_a] = a;
-		auto &[point_b, uv_b] = b;
-		auto &[point_c, uv_c] = c;
-		math::Triangle2d triangle(point_a, point_b, point_c);
-		auto [left_bottom, right_top] = triangle.bounding_box();
-		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
-			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
-				
-				std::vector<math::Point2d> sampled_points;
-				math::sample_pixel(sampled_points, {x, y}, scale);
-				int enclosed = 0;
-				for (auto &p : sampled_points) {
-					if (triangle.enclose(p)) enclosed ++;
-				}
-
-				auto factor = (decimal)enclosed / (scale * scale);
-				auto barycentric = math::get_factor(point_a, point_b, point_c, {x, y});
-				auto uv_x = math::calculate_weighed(uv_a.x(), uv_b.x(), uv_c.x(), barycentric);
-				auto uv_y = math::calculate_weighed(uv_a.y(), uv_b.y(), uv_c.y(), barycentric);
-
-				clamp(uv_x, 0.0, 1.0), clamp(uv_y, 0.0, 1.0);
-
-				result.push_back({{x, y}, image.at_uv(uv_x, uv_y, bilinear, warp_mode) * factor});
-			}
-	}
-
-	static void triangle_shader_data(
-		std::vector<Vertex_shader_data>& result,
-		const Vertex_shader_data& a,
-		const Vertex_shader_data& b,
-		const Vertex_shader_data& c,
-		int scale = 1
-	) {
-		result.clear();
-		auto &[point_a, color_a, uv_a, inv_a] = a;
-		auto &[point_b, color_b, uv_b, inv_b] = b;
-		auto &[point_c, color_c, uv_c, inv_c] = c;
-
-		auto pa = math::Point2d{point_a};
-		auto pb = math::Point2d{point_b};
-		auto pc = math::Point2d{point_c};
-		
-		math::Triangle2d triangle(pa, pb, pc);
-
-		auto [left_bottom, right_top] = triangle.bounding_box();
-		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
-			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
-				
-				std::vector<math::Point2d> sampled_points;
-				math::sample_pixel(sampled_points, {x, y}, scale);
-				int enclosed = 0;
-				for (auto &p : sampled_points) {
-					if (triangle.enclose(p)) enclosed ++;
-				}
-
-				if(!enclosed) continue;
-
-				auto factor = (decimal)enclosed / (scale * scale);
-				auto barycentric = math::get_factor(pa, pb, pc, math::Point2d{x, y});
-				auto inv = math::calculate_weighed(inv_a, inv_b, inv_c, barycentric);
-				auto depth = math::calculate_weighed(point_a.z(), point_b.z(), point_c.z(), barycentric);
-				auto color = math::calculate_weighed(color_a, color_b, color_c, barycentric) / inv;
-				auto uv = math::calculate_weighed(uv_a, uv_b, uv_c, barycentric) / inv;
-				color *= factor;
-				result.push_back({{x, y, depth, 1.0}, color, uv, inv});
-			}
-
-	}
-
-	static void image_fixed(std::vector<std::pair<math::Pixel, math::Color>>& result, const Image& image, const math::Pixel& start_point = {0, 0}) {
-		result.clear();
-		int start_x = start_point.x(), start_y = start_point.y();
-		for (int i = 0, y = start_y; i < image.height; i ++, y ++)
-			for (int j = 0, x = start_x; j < image.width; j ++, x ++) {
-				result.push_back({{x, y}, image.at(x, y)});
-			}
-	}
-
-	static void image(
-		std::vector<std::pair<math::Pixel, math::Color>>& result, 
-		const Image& image, 
-		const math::Pixel& start_point = {0, 0}, 
-		int width = 100, int height = 100, 
-		bool bilinear = true, 
-		WRAP_MODE warp_mode = WRAP_MODE::REPEAT,
-		FILL_MODE fill_mode = FILL_MODE::FIT_HEIGHT
-	) {
-		result.clear();
-		int stride_x = image.width / width, stride_y = image.height / height;
-		int start_x = start_point.x(), start_y = start_point.y();
-		for (int i = 0, y = start_y; i < height; i ++, y ++)
-			for (int j = 0, x = start_x; j < width; j ++, x ++) {
-
-				decimal u, v;
-				if (warp_mode == WRAP_MODE::NONE) {
-					u = (decimal)j / width, v = (decimal)i / height;
-				} else {
-					if (fill_mode == FILL_MODE::FIT_HEIGHT) {
-						u = (decimal)j / width * width / height / image.ratio(), v = (decimal)i / height; 
-					} else if (fill_mode == FILL_MODE::FIT_WIDTH) {
-						u = (decimal)j / width, v = (decimal)i / height * height / width * image.ratio(); 
-					} else {
-						u = (decimal)j / image.width, v = (decimal)i / image.height; 
-					}
-				}
-
-				result.push_back({{x, y}, image.at_uv(u, v, bilinear, warp_mode)});
-
-			}
-	}
-
+#pragma once
+
+#include "base.h"
+#include "maths.h"
+#include "image.h"
+#include "simd.h"
+
+class Raster {
+public:
+	//largest scale of the edge function rasterizers, scale * scale samples per pixel
+	static constexpr int max_scale = 4;
+
+	static void line_bresenham_colored(
+		std::vector<std::pair<math::Pixel, math::Color>>& result,
+		std::pair<math::Pixel, math::Color> pixel_a,
+		std::pair<math::Pixel, math::Color> pixel_b
+	) {
+
+		if (pixel_a.first.x() > pixel_b.first.x()) std::swap(pixel_a, pixel_b);
+
+		if (pixel_a.first == pixel_b.first) {
+			result.push_back({pixel_a.first, math::Color::alpha_blend(pixel_a.second, pixel_b.second)});
+			return;
+		}
+
+		auto &[a, color_a] = pixel_a;
+		auto &[b, color_b] = pixel_b;
+
+		bool down = false, surge = false;
+		result.clear();
+
+		int delta_x = b.x() - a.x();
+		int delta_y = b.y() - a.y();
+
+		if (delta_y < 0) {
+			b.y() = -b.y(), a.y() = -a.y();
+			delta_y = b.y() - a.y();
+			down = true;
+		}
+
+		if (delta_y > delta_x) {
+			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
+			delta_x = b.x() - a.x();
+			delta_y = b.y() - a.y();
+			surge = true;
+		}
+
+		//decimal mid_y = -delta_y * (a.x() + 1) + delta_x * (a.y() + 0.5) + a.x() * b.y() - b.x() * a.y();
+		// f(x) * 2 won't effect its relation between 0;
+		int mid_y = 2 * -delta_y * (a.x() + 1) + delta_x * (2 * a.y() + 1) + 2 * a.x() * b.y() - 2 * b.x() * a.y();
+
+		for (int x = a.x(), y = a.y(); x <= b.x(); x ++) {
+
+			auto red = math::interpolate<int, int>({a.x(), color_a.R()}, {b.x(), color_b.R()}, x);
+			auto green = math::interpolate<int, int>({a.x(), color_a.G()}, {b.x(), color_b.G()}, x);
+			auto blue = math::interpolate<int, int>({a.x(), color_a.B()}, {b.x(), color_b.B()}, x);
+			auto alpha = math::interpolate<int, int>({a.x(), color_a.A()}, {b.x(), color_b.A()}, x);
+			result.push_back({{x, y}, math::Color(red, green, blue, alpha)});
+			
+			if (mid_y < 0) {
+				y ++;
+				mid_y += 2 * (delta_x - delta_y);
+			} else {
+				mid_y -= 2 * delta_y;
+			}
+		}
+
+		if (surge) {
+			for (auto &p : result)
+				std::swap(p.first.x(), p.first.y());
+		}
+
+		if (down) {
+			for (auto &p : result)
+				p.first.y() = -p.first.y();
+		}
+
+	}
+
+	static void line_bresenham(
+		std::vector<math::Pixel>& result,
+		math::Pixel a,
+		math::Pixel b
+	)  {
+
+		if (a.x() > b.x()) std::swap(a, b);
+
+		if (a == b) {
+			result.push_back(a);
+			return;
+		}
+
+		bool down = false, surge = false;
+		result.clear();
+
+		int delta_x = b.x() - a.x();
+		int delta_y = b.y() - a.y();
+
+		if (delta_y < 0) {
+			b.y() = -b.y(), a.y() = -a.y();
+			delta_y = b.y() - a.y();
+			down = true;
+		}
+
+		if (delta_y > delta_x) {
+			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
+			delta_x = b.x() - a.x();
+			delta_y = b.y() - a.y();
+			surge = true;
+		}
+
+		//decimal mid_y = -delta_y * (a.x() + 1) + delta_x * (a.y() + 0.5) + a.x() * b.y() - b.x() * a.y();
+		// f(x) * 2 won't effect its relation between 0;
+		int mid_y = 2 * -delta_y * (a.x() + 1) + delta_x * (2 * a.y() + 1) + 2 * a.x() * b.y() - 2 * b.x() * a.y();
+
+		for (int x = a.x(), y = a.y(); x <= b.x(); x ++) {
+			result.push_back({x, y});
+			if (mid_y < 0) {
+				y ++;
+				mid_y += 2 * (delta_x - delta_y);
+			} else {
+				mid_y -= 2 * delta_y;
+			}
+		}
+
+		if (surge) {
+			for (auto &p : result)
+				std::swap(p.x(), p.y());
+		}
+
+		if (down) {
+			for (auto &p : result)
+				p.y() = -p.y();
+		}
+	}
+
+	static void line_alpha(
+		std::vector<std::pair<math::Pixel, decimal>>& result,
+		math::Pixel a,
+		math::Pixel b
+	)  {
+		
+		if (a.x() > b.x()) std::swap(a, b);
+
+		if (a == b) {
+			result.push_back({a, 1.0f});
+			return;
+		}
+
+		bool down = false, surge = false;
+		result.clear();
+
+		decimal delta_x = b.x() - a.x();
+		decimal delta_y = b.y() - a.y();
+
+		if (delta_y < 0) {
+			b.y() = -b.y(), a.y() = -a.y();
+			delta_y = b.y() - a.y();
+			down = true;
+		}
+
+		if (delta_y > delta_x) {
+			std::swap(b.x(), b.y()), std::swap(a.x(), a.y());
+			delta_x = b.x() - a.x();
+			delta_y = b.y() - a.y();
+			surge = true;
+		}
+
+		for (int x = a.x(); x <= b.x(); x ++) {
+			decimal y = ((decimal)delta_y / delta_x) * (x - a.x()) + a.y();
+			auto alpha0 = std::ceil(y) - y;
+			auto alpha1 = y - std::ceil(y - 1);
+			result.push_back({{x, (int)std::floor(y)}, alpha0});
+			result.push_back({{x, (int)std::ceil(y)}, alpha1});
+		}
+
+		if (surge) {
+			for (auto &p : result)
+				std::swap(p.first.x(), p.first.y());
+		}
+
+		if (down) {
+			for (auto &p : result)
+				p.first.y() = -p.first.y();
+		}
+	}
+
+	static void triangle_alpha(
+		std::vector<std::pair<math::Pixel, decimal>>& result,
+		const math::Point2d& a,
+		const math::Point2d& b,
+		const math::Point2d& c,
+		int scale = 1
+	) {
+		result.clear();
+		math::Triangle2d triangle(a, b, c);
+		auto [left_bottom, right_top] = triangle.bounding_box();
+		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
+			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
+				std::vector<math::Point2d> sampled_points;
+				math::sample_pixel(sampled_points, {x, y}, scale);
+				int enclosed = 0;
+				for (auto &p : sampled_points) {
+					if (triangle.enclose(p)) enclosed ++;
+				}
+				auto factor = (decimal)enclosed / sampled_points.size();
+				result.push_back({{x, y}, factor});
+			}
+	}
+
+	static void triangle_colored(
+		std::vector<std::pair<math::Pixel, math::Color>>& result,
+		const std::pair<math::Point2d, math::Color>& a,
+		const std::pair<math::Point2d, math::Color>& b,
+		const std::pair<math::Point2d, math::Color>& c,
+		int scale = 1
+	) {
+		result.clear();
+		auto &[point_a, color_a] = a;
+		auto &[point_b, color_b] = b;
+		auto &[point_c, color_c] = c;
+		math::Triangle2d triangle(point_a, point_b, point_c);
+		auto [left_bottom, right_top] = triangle.bounding_box();
+		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
+			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
+				
+				std::vector<math::Point2d> sampled_points;
+				math::sample_pixel(sampled_points, {x, y}, scale);
+				int enclosed = 0;
+				for (auto &p : sampled_points) {
+					if (triangle.enclose(p)) enclosed ++;
+				}
+
+				auto factor = (decimal)enclosed / (scale * scale);
+				auto barycentric = math::get_factor(point_a, point_b, point_c, {x, y});
+
+				auto color = math::Color::interpolate_color(color_a, color_b, color_c, barycentric);
+				color *= factor;
+
+				result.push_back({{x, y}, color});
+			}
+	}
+
+	static void triangle_textured(
+		std::vector<std::pair<math::Pixel, math::Color>>& result,
+		const std::pair<math::Point2d, math::UV>& a,
+		const std::pair<math::Point2d, math::UV>& b,
+		const std::pair<math::Point2d, math::UV>& c,
+		const Image& image,
+		int scale = 1,
+		bool bilinear = true,
+		WRAP_MODE warp_mode = WRAP_MODE::REPEAT
+	) {
+		result.clear();
+		auto &[point_a, uv_a] = a;
+		auto &[point_b, uv_b] = b;
+		auto &[point_c, uv_c] = c;
+		math::Triangle2d triangle(point_a, point_b, point_c);
+		auto [left_bottom, right_top] = triangle.bounding_box();
+		for (int x = left_bottom.x(); x <= right_top.x(); x ++)
+			for (int y = left_bottom.y(); y <= right_top.y(); y ++) {
+				
+				std::vector<math::Point2d> sampled_points;
+				math::sample_pixel(sampled_points, {x, y}, scale);
+				int enclosed = 0;
+				for (auto &p : sampled_points) {
+					if (triangle.enclose(p)) enclosed ++;
+				}
+
+				auto factor = (decimal)enclosed / (scale * scale);
+				auto barycentric = math::get_factor(point_a, point_b, point_c, {x, y});
+				auto uv_x = math::calculate_weighed(uv_a.x(), uv_b.x(), uv_c.x(), barycentric);
+				auto uv_y = math::calculate_weighed(uv_a.y(), uv_b.y(), uv_c.y(), barycentric);
+
+				clamp(uv_x, 0.0, 1.0), clamp(uv_y, 0.0, 1.0);
+
+				result.push_back({{x, y}, image.at_uv(uv_x, uv_y, bilinear, warp_mode) * factor});
+			}
+	}
+
+	static void triangle_shader_data(
+		std::vector<Vertex_shader_data>& result,
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		int scale = 1
+	) {
+		triangle_shader_data(result, a, b, c, scale, {
+			{std::numeric_limits<int>::min(), std::numeric_limits<int>::min()},
+			{std::numeric_limits<int>::max(), std::numeric_limits<int>::max()}
+		});
+	}
+
+	//only pixels inside bounds (inclusive) are produced
+	static void triangle_shader_data(
+		std::vector<Vertex_shader_data>& result,
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		int scale,
+		const std::pair<math::Pixel, math::Pixel>& bounds
+	) {
+		result.clear();
+		triangle_shader_data(a, b, c, scale, bounds, [&](const Vertex_shader_data& fragment) {
+			result.push_back(fragment);
+		});
+	}
+
+	//size of the pixel blocks the triangle is walked in, matches the coarse depth tiles of the frame buffer
+	static constexpr int block_size = 8;
+
+	//accepts every block and pixel, see GPU::Early_depth_test for the real one
+	struct No_depth_test {
+		bool block(const math::Pixel& left_bottom, const math::Pixel& right_top, decimal max_depth) const { return true; }
+		bool pixel(int x, int y, decimal depth) const { return true; }
+	};
+
+	//interpolates depth, 1/w and the varyings of the covered lanes from their barycentric weights w_a, w_b, w_c
+	//and emits the fragments of pixels x .. x + 3 that pass depth_test
+	template<typename F, typename D>
+	static void interpolate_lanes(
+		int x, int y,
+		int covered,
+		const std::array<int, math::Lane4::size>& enclosed,
+		int scale,
+		const math::Lane4& w_a,
+		const math::Lane4& w_b,
+		const math::Lane4& w_c,
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		F& emit,
+		D& depth_test
+	) {
+		constexpr int lanes = math::Lane4::size;
+		auto &[point_a, color_a, uv_a, inv_a] = a;
+		auto &[point_b, color_b, uv_b, inv_b] = b;
+		auto &[point_c, color_c, uv_c, inv_c] = c;
+
+		std::array<decimal, lanes> depth{};
+		math::Lane4::weighed(point_a.z(), point_b.z(), point_c.z(), w_a, w_b, w_c).store(depth.data());
+
+		for (int i = 0; i < lanes; i ++) {
+			if ((covered >> i & 1) && !depth_test.pixel(x + i, y, depth[i])) covered &= ~(1 << i);
+		}
+
+		if (!covered) return;
+
+		auto inv_lanes = math::Lane4::weighed(inv_a, inv_b, inv_c, w_a, w_b, w_c);
+		std::array<decimal, lanes> inv{}, r{}, g{}, blue{}, alpha{}, u{}, v{};
+		inv_lanes.store(inv.data());
+		(math::Lane4::weighed(color_a.x(), color_b.x(), color_c.x(), w_a, w_b, w_c) / inv_lanes).store(r.data());
+		(math::Lane4::weighed(color_a.y(), color_b.y(), color_c.y(), w_a, w_b, w_c) / inv_lanes).store(g.data());
+		(math::Lane4::weighed(color_a.z(), color_b.z(), color_c.z(), w_a, w_b, w_c) / inv_lanes).store(blue.data());
+		(math::Lane4::weighed(color_a.w(), color_b.w(), color_c.w(), w_a, w_b, w_c) / inv_lanes).store(alpha.data());
+		(math::Lane4::weighed(uv_a.x(), uv_b.x(), uv_c.x(), w_a, w_b, w_c) / inv_lanes).store(u.data());
+		(math::Lane4::weighed(uv_a.y(), uv_b.y(), uv_c.y(), w_a, w_b, w_c) / inv_lanes).store(v.data());
+
+		for (int i = 0; i < lanes; i ++) {
+			if (!(covered >> i & 1)) continue;
+			auto factor = (decimal)enclosed[i] / (scale * scale);
+			math::Color_decimal color{r[i], g[i], blue[i], alpha[i]};
+			color *= factor;
+			emit(Vertex_shader_data{{x + i, y, depth[i], 1.0}, color, {u[i], v[i]}, inv[i]});
+		}
+	}
+
+	//fragments are handed to emit one by one instead of being collected,
+	//depth_test may reject whole blocks or single pixels before any varying is interpolated
+	template<typename F, typename D = No_depth_test>
+	static void triangle_shader_data(
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		int scale,
+		const std::pair<math::Pixel, math::Pixel>& bounds,
+		F&& emit,
+		D&& depth_test = D{}
+	) {
+		if (scale < 1 || scale > max_scale) throw std::invalid_argument("invalid MSAA scale");
+		auto &[point_a, color_a, uv_a, inv_a] = a;
+		auto &[point_b, color_b, uv_b, inv_b] = b;
+		auto &[point_c, color_c, uv_c, inv_c] = c;
+
+		auto pa = math::Point2d{point_a};
+		auto pb = math::Point2d{point_b};
+		auto pc = math::Point2d{point_c};
+		
+		math::Triangle2d triangle(pa, pb, pc);
+
+		//edge functions opposite to a, b and c, their values at p are the barycentric weights scaled by area2
+		math::Edge2d edge_a(pb, pc), edge_b(pc, pa), edge_c(pa, pb);
+		decimal area2 = edge_a.evaluate(pa.x(), pa.y());
+		if (!sign(area2)) return;
+		if (area2 < 0) edge_a.flip(), edge_b.flip(), edge_c.flip(), area2 = -area2;
+		decimal inv_area2 = 1.0 / area2;
+
+		//depth is affine in screen space, written as an edge function of its own
+		math::Edge2d depth_plane;
+		depth_plane.a = (edge_a.a * point_a.z() + edge_b.a * point_b.z() + edge_c.a * point_c.z()) * inv_area2;
+		depth_plane.b = (edge_a.b * point_a.z() + edge_b.b * point_b.z() + edge_c.b * point_c.z()) * inv_area2;
+		depth_plane.c = (edge_a.c * point_a.z() + edge_b.c * point_b.z() + edge_c.c * point_c.z()) * inv_area2;
+		decimal max_vertex_depth = std::max({point_a.z(), point_b.z(), point_c.z()});
+
+		//sample offsets relative to the pixel center, applied to each edge once per triangle
+		std::array<std::tuple<math::Lane4, math::Lane4, math::Lane4>, max_scale * max_scale> sample_storage;
+		std::span sample_offsets(sample_storage.data(), scale * scale);
+		decimal stride = 1.0 / scale;
+		for (int i = 0; i < scale; i ++)
+			for (int j = 0; j < scale; j ++) {
+				decimal dx = stride * (i + 0.5) - 0.5, dy = stride * (j + 0.5) - 0.5;
+				sample_offsets[i * scale + j] = {
+					math::Lane4::broadcast(edge_a.step(dx, dy)),
+					math::Lane4::broadcast(edge_b.step(dx, dy)),
+					math::Lane4::broadcast(edge_c.step(dx, dy))
+				};
+			}
+
+		//pixels x .. x + 3 of a row are processed together in the lanes
+		constexpr int lanes = math::Lane4::size;
+		auto lane_x = math::Lane4::set(0.0, 1.0, 2.0, 3.0);
+		auto zero = math::Lane4::broadcast(0.0);
+		auto inv_area2_lanes = math::Lane4::broadcast(inv_area2);
+		auto step_a = math::Lane4::broadcast(edge_a.a * lanes);
+		auto step_b = math::Lane4::broadcast(edge_b.a * lanes);
+		auto step_c = math::Lane4::broadcast(edge_c.a * lanes);
+
+		auto [left_bottom, right_top] = triangle.bounding_box();
+		int min_x = std::max(left_bottom.x(), bounds.first.x()), max_x = std::min(right_top.x(), bounds.second.x());
+		int min_y = std::max(left_bottom.y(), bounds.first.y()), max_y = std::min(right_top.y(), bounds.second.y());
+		if (min_x > max_x || min_y > max_y) return;
+
+		auto block_floor = [](int v) { return (v >= 0 ? v / block_size : (v + 1) / block_size - 1) * block_size; };
+
+		for (int block_y = block_floor(min_y); block_y <= max_y; block_y += block_size)
+			for (int block_x = block_floor(min_x); block_x <= max_x; block_x += block_size) {
+				int x0 = std::max(block_x, min_x), x1 = std::min(block_x + block_size - 1, max_x);
+				int y0 = std::max(block_y, min_y), y1 = std::min(block_y + block_size - 1, max_y);
+
+				//every sample of the block lies outside one edge
+				if (edge_a.max(x0, y0, x1 + 1, y1 + 1) <= 0) continue;
+				if (edge_b.max(x0, y0, x1 + 1, y1 + 1) <= 0) continue;
+				if (edge_c.max(x0, y0, x1 + 1, y1 + 1) <= 0) continue;
+
+				decimal max_depth = std::min(depth_plane.max(x0 + 0.5, y0 + 0.5, x1 + 0.5, y1 + 0.5), max_vertex_depth);
+				if (!depth_test.block({x0, y0}, {x1, y1}, max_depth)) continue;
+
+				for (int y = y0; y <= y1; y ++) {
+					//row start is evaluated directly so that stepping error never accumulates across rows
+					auto e_a = math::Lane4::broadcast(edge_a.evaluate(x0 + 0.5, y + 0.5)) + math::Lane4::broadcast(edge_a.a) * lane_x;
+					auto e_b = math::Lane4::broadcast(edge_b.evaluate(x0 + 0.5, y + 0.5)) + math::Lane4::broadcast(edge_b.a) * lane_x;
+					auto e_c = math::Lane4::broadcast(edge_c.evaluate(x0 + 0.5, y + 0.5)) + math::Lane4::broadcast(edge_c.a) * lane_x;
+
+					for (int x = x0; x <= x1; x += lanes, e_a = e_a + step_a, e_b = e_b + step_b, e_c = e_c + step_c) {
+
+						int valid = (1 << std::min(lanes, x1 - x + 1)) - 1;
+						int covered = 0;
+						std::array<int, lanes> enclosed{};
+						for (auto &[d_a, d_b, d_c] : sample_offsets) {
+							int mask = (e_a + d_a).greater_mask(zero) & (e_b + d_b).greater_mask(zero) & (e_c + d_c).greater_mask(zero) & valid;
+							covered |= mask;
+							for (int i = 0; i < lanes; i ++) enclosed[i] += (mask >> i) & 1;
+						}
+
+						if (!covered) continue;
+
+						interpolate_lanes(x, y, covered, enclosed, scale, e_a * inv_area2_lanes, e_b * inv_area2_lanes, e_c * inv_area2_lanes, a, b, c, emit, depth_test);
+					}
+				}
+			}
+
+	}
+
+	//bresenham between the pixels holding a and b, the pixel of b is left out so connected lines
+	//share one pixel. depth, 1/w and the varyings, already divided by w, step by a constant per
+	//pixel along the major axis instead of being interpolated per pixel
+	template<typename F, typename D = No_depth_test>
+	static void line_shader_data(
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const std::pair<math::Pixel, math::Pixel>& bounds,
+		F&& emit,
+		D&& depth_test = D{}
+	) {
+		int x0 = (int)std::floor(a.position.x()), y0 = (int)std::floor(a.position.y());
+		int x1 = (int)std::floor(b.position.x()), y1 = (int)std::floor(b.position.y());
+		int delta_x = std::abs(x1 - x0), delta_y = std::abs(y1 - y0);
+		int step_x = x0 < x1 ? 1 : -1, step_y = y0 < y1 ? 1 : -1;
+		int steps = std::max(delta_x, delta_y);
+		if (!steps) return;
+
+		//depth, 1/w, r, g, b, alpha, u, v
+		constexpr int varyings = 8;
+		std::array<decimal, varyings> value{
+			a.position.z(), a.inv_w, a.color.x(), a.color.y(), a.color.z(), a.color.w(), a.uv.x(), a.uv.y()
+		};
+		std::array<decimal, varyings> end{
+			b.position.z(), b.inv_w, b.color.x(), b.color.y(), b.color.z(), b.color.w(), b.uv.x(), b.uv.y()
+		};
+		std::array<decimal, varyings> delta{};
+		for (int k = 0; k < varyings; k ++) delta[k] = (end[k] - value[k]) / steps;
+
+		auto &[left_bottom, right_top] = bounds;
+		bool x_major = delta_x >= delta_y;
+		int error = x_major ? 2 * delta_y - delta_x : 2 * delta_x - delta_y;
+
+		for (int i = 0, x = x0, y = y0; i < steps; i ++) {
+			bool inside = x >= left_bottom.x() && x <= right_top.x() && y >= left_bottom.y() && y <= right_top.y();
+			if (inside && depth_test.pixel(x, y, value[0])) {
+				decimal w = 1.0 / value[1];
+				emit(Vertex_shader_data{
+					{x, y, value[0], 1.0},
+					{value[2] * w, value[3] * w, value[4] * w, value[5] * w},
+					{value[6] * w, value[7] * w},
+					value[1]
+				});
+			}
+
+			if (x_major) {
+				x += step_x;
+				if (error > 0) y += step_y, error -= 2 * delta_x;
+				error += 2 * delta_y;
+			} else {
+				y += step_y;
+				if (error > 0) x += step_x, error -= 2 * delta_y;
+				error += 2 * delta_x;
+			}
+			for (int k = 0; k < varyings; k ++) value[k] += delta[k];
+		}
+	}
+
+	//sub-pixel precision of the fixed point rasterizer, coordinates are snapped to 24.8
+	static constexpr int subpixel_bits = 8;
+	static constexpr int64_t subpixel_one = int64_t{ 1 } << subpixel_bits;
+
+	//same as triangle_shader_data, but vertices are snapped to the sub-pixel grid and coverage is
+	//decided by exact integer edge functions with a top-left rule. A sample on an edge shared by
+	//two triangles is covered by exactly one of them, whatever the tile or thread rasterizing it
+	template<typename F, typename D = No_depth_test>
+	static void triangle_shader_data_fixed(
+		const Vertex_shader_data& a,
+		const Vertex_shader_data& b,
+		const Vertex_shader_data& c,
+		int scale,
+		const std::pair<math::Pixel, math::Pixel>& bounds,
+		F&& emit,
+		D&& depth_test = D{}
+	) {
+		if (scale < 1 || scale > max_scale) throw std::invalid_argument("invalid MSAA scale");
+		auto &point_a = a.position, &point_b = b.position, &point_c = c.position;
+
+		auto snap = [](decimal v) { return (int64_t)std::llround(v * subpixel_one); };
+		int64_t ax = snap(point_a.x()), ay = snap(point_a.y());
+		int64_t bx = snap(point_b.x()), by = snap(point_b.y());
+		int64_t cx = snap(point_c.x()), cy = snap(point_c.y());
+
+		math::Fixed_edge2d edge_a(bx, by, cx, cy), edge_b(cx, cy, ax, ay), edge_c(ax, ay, bx, by);
+		int64_t area2 = edge_a.evaluate(ax, ay);
+		if (!area2) return;
+		if (area2 < 0) edge_a.flip(), edge_b.flip(), edge_c.flip(), area2 = -area2;
+		decimal inv_area2 = 1.0 / (decimal)area2;
+
+		//samples exactly on an edge only count for the edge owning them
+		int64_t bias_a = edge_a.top_left() ? 1 : 0, bias_b = edge_b.top_left() ? 1 : 0, bias_c = edge_c.top_left() ? 1 : 0;
+
+		//depth plane in pixel units
+		math::Edge2d depth_plane;
+		depth_plane.a = ((decimal)edge_a.a * point_a.z() + (decimal)edge_b.a * point_b.z() + (decimal)edge_c.a * point_c.z()) * inv_area2 * subpixel_one;
+		depth_plane.b = ((decimal)edge_a.b * point_a.z() + (decimal)edge_b.b * point_b.z() + (decimal)edge_c.b * point_c.z()) * inv_area2 * subpixel_one;
+		depth_plane.c = ((decimal)edge_a.c * point_a.z() + (decimal)edge_b.c * point_b.z() + (decimal)edge_c.c * point_c.z()) * inv_area2;
+		decimal max_vertex_depth = std::max({point_a.z(), point_b.z(), point_c.z()});
+
+		//sample offsets relative to the pixel center in sub-pixels, applied to each edge once per triangle
+		std::array<std::tuple<int64_t, int64_t, int64_t>, max_scale * max_scale> sample_storage;
+		std::span sample_offsets(sample_storage.data(), scale * scale);
+		for (int i = 0; i < scale; i ++)
+			for (int j = 0; j < scale; j ++) {
+				int64_t dx = (2 * i + 1) * subpixel_one / (2 * scale) - subpixel_one / 2;
+				int64_t dy = (2 * j + 1) * subpixel_one / (2 * scale) - subpixel_one / 2;
+				sample_offsets[i * scale + j] = {edge_a.step(dx, dy) + bias_a, edge_b.step(dx, dy) + bias_b, edge_c.step(dx, dy) + bias_c};
+			}
+
+		constexpr int lanes = math::Lane4::size;
+		auto inv_area2_lanes = math::Lane4::broadcast(inv_area2);
+
+		int min_x = std::max((int)(std::min({ax, bx, cx}) >> subpixel_bits), bounds.first.x());
+		int max_x = std::min((int)(std::max({ax, bx, cx}) >> subpixel_bits), bounds.second.x());
+		int min_y = std::max((int)(std::min({ay, by, cy}) >> subpixel_bits), bounds.first.y());
+		int max_y = std::min((int)(std::max({ay, by, cy}) >> subpixel_bits), bounds.second.y());
+		if (min_x > max_x || min_y > max_y) return;
+
+		auto block_floor = [](int v) { return (v >= 0 ? v / block_size : (v + 1) / block_size - 1) * block_size; };
+
+		for (int block_y = block_floor(min_y); block_y <= max_y; block_y += block_size)
+			for (int block_x = block_floor(min_x); block_x <= max_x; block_x += block_size) {
+				int x0 = std::max(block_x, min_x), x1 = std::min(block_x + block_size - 1, max_x);
+				int y0 = std::max(block_y, min_y), y1 = std::min(block_y + block_size - 1, max_y);
+
+				//every sample of the block lies outside one edge
+				int64_t sx0 = x0 * subpixel_one, sy0 = y0 * subpixel_one;
+				int64_t sx1 = (x1 + 1) * subpixel_one, sy1 = (y1 + 1) * subpixel_one;
+				if (edge_a.max(sx0, sy0, sx1, sy1) + bias_a <= 0) continue;
+				if (edge_b.max(sx0, sy0, sx1, sy1) + bias_b <= 0) continue;
+				if (edge_c.max(sx0, sy0, sx1, sy1) + bias_c <= 0) continue;
+
+				decimal max_depth = std::min(depth_plane.max(x0 + 0.5, y0 + 0.5, x1 + 0.5, y1 + 0.5), max_vertex_depth);
+				if (!depth_test.block({x0, y0}, {x1, y1}, max_depth)) continue;
+
+				for (int y = y0; y <= y1; y ++) {
+					int64_t center_y = y * subpixel_one + subpixel_one / 2;
+					int64_t e_a = edge_a.evaluate(x0 * subpixel_one + subpixel_one / 2, center_y);
+					int64_t e_b = edge_b.evaluate(x0 * subpixel_one + subpixel_one / 2, center_y);
+					int64_t e_c = edge_c.evaluate(x0 * subpixel_one + subpixel_one / 2, center_y);
+
+					for (int x = x0; x <= x1; x += lanes) {
+						std::array<int64_t, lanes> lane_a{}, lane_b{}, lane_c{};
+						std::array<int, lanes> enclosed{};
+						int covered = 0;
+
+						for (int i = 0; i < lanes && x + i <= x1; i ++) {
+							lane_a[i] = e_a, lane_b[i] = e_b, lane_c[i] = e_c;
+							for (auto &[d_a, d_b, d_c] : sample_offsets) {
+								if (e_a + d_a > 0 && e_b + d_b > 0 && e_c + d_c > 0) enclosed[i] ++;
+							}
+							if (enclosed[i]) covered |= 1 << i;
+							e_a += edge_a.a * subpixel_one, e_b += edge_b.a * subpixel_one, e_c += edge_c.a * subpixel_one;
+						}
+
+						if (!covered) continue;
+
+						//the pixel center may lie outside for partially covered pixels, weights are extrapolated then
+						auto w_a = math::Lane4::set(lane_a[0], lane_a[1], lane_a[2], lane_a[3]) * inv_area2_lanes;
+						auto w_b = math::Lane4::set(lane_b[0], lane_b[1], lane_b[2], lane_b[3]) * inv_area2_lanes;
+						auto w_c = math::Lane4::set(lane_c[0], lane_c[1], lane_c[2], lane_c[3]) * inv_area2_lanes;
+						interpolate_lanes(x, y, covered, enclosed, scale, w_a, w_b, w_c, a, b, c, emit, depth_test);
+					}
+				}
+			}
+
+	}
+
+	static void image_fixed(std::vector<std::pair<math::Pixel, math::Color>>& result, const Image& image, const math::Pixel& start_point = {0, 0}) {
+		result.clear();
+		int start_x = start_point.x(), start_y = start_point.y();
+		for (int i = 0, y = start_y; i < image.height; i ++, y ++)
+			for (int j = 0, x = start_x; j < image.width; j ++, x ++) {
+				result.push_back({{x, y}, image.at(x, y)});
+			}
+	}
+
+	static void image(
+		std::vector<std::pair<math::Pixel, math::Color>>& result, 
+		const Image& image, 
+		const math::Pixel& start_point = {0, 0}, 
+		int width = 100, int height = 100, 
+		bool bilinear = true, 
+		WRAP_MODE warp_mode = WRAP_MODE::REPEAT,
+		FILL_MODE fill_mode = FILL_MODE::FIT_HEIGHT
+	) {
+		result.clear();
+		int stride_x = image.width / width, stride_y = image.height / height;
+		int start_x = start_point.x(), start_y = start_point.y();
+		for (int i = 0, y = start_y; i < height; i ++, y ++)
+			for (int j = 0, x = start_x; j < width; j ++, x ++) {
+
+				decimal u, v;
+				if (warp_mode == WRAP_MODE::NONE) {
+					u = (decimal)j / width, v = (decimal)i / height;
+				} else {
+					if (fill_mode == FILL_MODE::FIT_HEIGHT) {
+						u = (decimal)j / width * width / height / image.ratio(), v = (decimal)i / height; 
+					} else if (fill_mode == FILL_MODE::FIT_WIDTH) {
+						u = (decimal)j / width, v = (decimal)i / height * height / width * image.ratio(); 
+					} else {
+						u = (decimal)j / image.width, v = (decimal)i / image.height; 
+					}
+				}
+
+				result.push_back({{x, y}, image.at_uv(u, v, bilinear, warp_mode)});
+
+			}
+	}
+
 };
\ No newline at end of file
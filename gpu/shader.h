@@ -18,11 +18,29 @@ struct Fragment_shader_data {
 	math::UV uv{};
 };
 
+//vertex_shader and fragment_shader may be called from several worker threads at once
 class Shader {
 public:
 	virtual ~Shader() = default;
 	virtual Vertex_shader_data vertex_shader(const Vertex_shader_data& input) = 0;
 	virtual Fragment_shader_data fragment_shader(const Vertex_shader_data& input) = 0;
+
+	//shades input[i] into output[i], both have the same size. The pipeline hands over a batch at a time,
+	//such as the fragments of a triangle in a tile, overriding this saves a virtual call per fragment
+	virtual void fragment_shader_batch(std::span<const Vertex_shader_data> input, std::span<Fragment_shader_data> output) {
+		for (size_t i = 0; i < input.size(); i ++) output[i] = fragment_shader(input[i]);
+	}
+
+	//shaders that output a depth other than the interpolated one must return true, this disables early depth test
+	[[nodiscard]] virtual bool writes_depth() const { return false; }
+
+	//instanced draws call this before the vertices of each instance are shaded,
+	//attributes holds size values of the instance stream or is nullptr when no stream is set
+	virtual void bind_instance(int instance_id, const decimal* attributes, int size) { }
+
+	//instanced draws call this after the last instance, shaders drop what bind_instance set
+	//so that later draws see their own uniforms again
+	virtual void unbind_instance() { }
 };
 
 class Default_Shader : public Shader {
@@ -31,6 +49,10 @@ public:
 	math::Transform3d view{};
 	math::Transform3d projection{};
 
+	//model matrix of the instance being drawn, set by bind_instance
+	math::Transform3d instance_model{};
+	bool instanced{ false };
+
 	Default_Shader() = default;
 	~Default_Shader() override = default;
 
@@ -46,12 +68,20 @@ public:
 		math::Transform3d  &&projection_
 	) : model(std::move(model_)), view(std::move(view_)), projection(std::move(projection_)) { }
 
+	//an instance stream of 16 values replaces the model matrix while the instance is drawn, row major
+	void bind_instance(int instance_id, const decimal* attributes, int size) override {
+		instanced = attributes && size >= 16;
+		if (instanced) instance_model = math::Transform3d(attributes, 16);
+	}
+
+	void unbind_instance() override { instanced = false; }
+
 	Vertex_shader_data vertex_shader(const Vertex_shader_data& input) override {
-		auto clip = projection * view * model * input.position;
+		auto clip = projection * view * (instanced ? instance_model : model) * input.position;
 		return { clip,
 				 input.color,
 				 input.uv, 
-				 1.0 / clip.w()};
+				 (decimal)1.0 / clip.w()};
 	}
 
 	Fragment_shader_data fragment_shader(const Vertex_shader_data& input) override {
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "base.h"
+#include "frame_buffer.h"
+
+// two or three frame buffers cycled between the renderer and a present thread. The renderer
+// draws into the buffer returned by acquire and hands it over with swap, the present thread
+// calls present on swapped buffers in order and releases each one afterwards. acquire blocks
+// only while every other buffer is still queued or being presented
+class Swap_chain {
+public:
+	using Present = std::function<void(const Frame_buffer&, int)>;
+
+private:
+	std::vector<std::shared_ptr<Frame_buffer>> buffers{};
+	Present present{};
+
+	std::mutex mutex{};
+	std::condition_variable changed{};
+	std::deque<int> free_buffers{};
+	//buffer and frame number of every swapped buffer not presented yet
+	std::deque<std::pair<int, int>> queued{};
+	int back{ -1 };
+	int presenting{ -1 };
+	int frame{ 0 };
+	bool stopping{ false };
+	std::exception_ptr exception{ nullptr };
+	std::thread thread{};
+
+	void loop() {
+		while (true) {
+			std::pair<int, int> item;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&]() { return stopping || !queued.empty(); });
+				if (queued.empty()) return;
+				item = queued.front();
+				queued.pop_front();
+				presenting = item.first;
+			}
+
+			try {
+				present(*buffers[item.first], item.second);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!exception) exception = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				presenting = -1;
+				free_buffers.push_back(item.first);
+			}
+			changed.notify_all();
+		}
+	}
+
+	//called with the mutex held
+	void rethrow() {
+		if (!exception) return;
+		auto result = exception;
+		exception = nullptr;
+		std::rethrow_exception(result);
+	}
+
+public:
+	Swap_chain(int width, int height, int count, Present present_) : present(std::move(present_)) {
+		if (count < 2 || count > 3) throw std::invalid_argument("invalid buffer count");
+		if (!present) throw std::invalid_argument("invalid present function");
+		for (int i = 0; i < count; i ++) {
+			buffers.push_back(std::make_shared<Frame_buffer>(width, height));
+			free_buffers.push_back(i);
+		}
+		thread = std::thread(&Swap_chain::loop, this);
+	}
+
+	//presents every swapped buffer before returning
+	~Swap_chain() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		changed.notify_all();
+		thread.join();
+	}
+
+	Swap_chain(const Swap_chain&) = delete;
+	Swap_chain& operator=(const Swap_chain&) = delete;
+
+	[[nodiscard]] int size() const { return (int)buffers.size(); }
+
+	//the back buffer, the same one until it is swapped. An exception thrown by present is rethrown here
+	std::shared_ptr<Frame_buffer> acquire() {
+		std::unique_lock<std::mutex> lock(mutex);
+		rethrow();
+		if (back >= 0) return buffers[back];
+		changed.wait(lock, [&]() { return !free_buffers.empty(); });
+		back = free_buffers.front();
+		free_buffers.pop_front();
+		return buffers[back];
+	}
+
+	//queues the back buffer for presenting, the renderer must not touch it until acquired again
+	void swap() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			rethrow();
+			if (back < 0) throw std::invalid_argument("no back buffer acquired");
+			queued.emplace_back(back, frame ++);
+			back = -1;
+		}
+		changed.notify_all();
+	}
+
+	//waits until every swapped buffer was presented
+	void wait_idle() {
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [&]() { return queued.empty() && presenting < 0; });
+		rethrow();
+	}
+
+};
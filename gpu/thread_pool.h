@@ -0,0 +1,104 @@
+#pragma once
+
+#include "base.h"
+
+// persistent workers for the parallel pipeline stages, the calling thread takes part as worker 0
+class Thread_pool {
+private:
+	std::vector<std::thread> threads{};
+	std::mutex mutex{};
+	std::condition_variable wake{}, done{};
+
+	std::function<void(int, int)> task{};
+	int task_count{ 0 };
+	std::atomic<int> next_task{ 0 };
+	int generation{ 0 };
+	int busy{ 0 };
+	bool stopping{ false };
+	std::exception_ptr exception{ nullptr };
+
+	void run(int worker) {
+		for (int i = next_task++; i < task_count; i = next_task++) {
+			try {
+				task(i, worker);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!exception) exception = std::current_exception();
+				next_task = task_count;
+			}
+		}
+	}
+
+	void loop(int worker) {
+		int seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]() { return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+			}
+			run(worker);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (-- busy == 0) done.notify_one();
+			}
+		}
+	}
+
+public:
+	explicit Thread_pool(int size) {
+		if (size <= 0) throw std::invalid_argument("invalid thread count");
+		for (int i = 1; i < size; i ++) threads.emplace_back(&Thread_pool::loop, this, i);
+	}
+
+	~Thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto &thread : threads) thread.join();
+	}
+
+	Thread_pool(const Thread_pool&) = delete;
+	Thread_pool& operator=(const Thread_pool&) = delete;
+
+	[[nodiscard]] int size() const { return (int)threads.size() + 1; }
+
+	//calls task(i, worker) for every i in [0, count) and returns once all calls are done,
+	//worker is in [0, size()) and identifies the calling thread for per-worker scratch data.
+	//the first exception thrown by a task is rethrown here, the remaining tasks are skipped.
+	//not reentrant, only one parallel_for runs at a time
+	template<typename F>
+	void parallel_for(int count, F&& f) {
+		if (count <= 0) return;
+		if (threads.empty() || count == 1) {
+			for (int i = 0; i < count; i ++) f(i, 0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			task = std::ref(f);
+			task_count = count;
+			next_task = 0;
+			exception = nullptr;
+			busy = (int)threads.size();
+			generation ++;
+		}
+		wake.notify_all();
+
+		run(0);
+
+		std::exception_ptr result{ nullptr };
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [&]() { return busy == 0; });
+			task = nullptr;
+			std::swap(result, exception);
+		}
+		if (result) std::rethrow_exception(result);
+	}
+
+};
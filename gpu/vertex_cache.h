@@ -0,0 +1,39 @@
+#pragma once
+
+#include "base.h"
+#include "shader.h"
+
+// FIFO post-transform cache, maps vertex ids to vertex shader outputs
+class Vertex_cache {
+private:
+	std::vector<int> tags{};
+	std::vector<Vertex_shader_data> entries{};
+	int next{ 0 };
+
+public:
+	explicit Vertex_cache(int size = 32) : tags(size, -1), entries(size) {
+		if (size <= 0) throw std::invalid_argument("invalid cache size");
+	}
+
+	void clear() {
+		std::fill(tags.begin(), tags.end(), -1);
+		next = 0;
+	}
+
+	[[nodiscard]] const Vertex_shader_data* find(int vertex_id) const {
+		for (int i = 0; i < tags.size(); i ++) {
+			if (tags[i] == vertex_id) return &entries[i];
+		}
+		return nullptr;
+	}
+
+	//replaces the oldest entry
+	const Vertex_shader_data& insert(int vertex_id, Vertex_shader_data&& data) {
+		int slot = next;
+		next = (next + 1) % (int)tags.size();
+		tags[slot] = vertex_id;
+		entries[slot] = std::move(data);
+		return entries[slot];
+	}
+
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "base.h"
+#include "shader.h"
+
+// shaded vertices stored as one contiguous array per component, the stages after vertex shading
+// walk only the arrays they read and write instead of whole Vertex_shader_data
+struct Vertex_streams {
+	std::vector<decimal> x{}, y{}, z{}, w{};
+	std::vector<decimal> r{}, g{}, b{}, a{};
+	std::vector<decimal> u{}, v{};
+	std::vector<decimal> inv_w{};
+
+	[[nodiscard]] int size() const { return (int)x.size(); }
+
+	void resize(int size) {
+		for (auto component : components()) component->resize(size);
+	}
+
+	void clear() { resize(0); }
+
+	void set(int i, const Vertex_shader_data& data) {
+		x[i] = data.position.x(), y[i] = data.position.y(), z[i] = data.position.z(), w[i] = data.position.w();
+		r[i] = data.color.x(), g[i] = data.color.y(), b[i] = data.color.z(), a[i] = data.color.w();
+		u[i] = data.uv.x(), v[i] = data.uv.y();
+		inv_w[i] = data.inv_w;
+	}
+
+	//returns the index of the appended vertex
+	int push_back(const Vertex_shader_data& data) {
+		int i = size();
+		resize(i + 1);
+		set(i, data);
+		return i;
+	}
+
+	[[nodiscard]] Vertex_shader_data operator[](int i) const {
+		return {{x[i], y[i], z[i], w[i]}, {r[i], g[i], b[i], a[i]}, {u[i], v[i]}, inv_w[i]};
+	}
+
+private:
+	std::array<std::vector<decimal>*, 11> components() {
+		return {&x, &y, &z, &w, &r, &g, &b, &a, &u, &v, &inv_w};
+	}
+
+};
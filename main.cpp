@@ -5,6 +5,7 @@
 #include "base.h"
 #include "color.h"
 #include "camera.h"
+#include "swap_chain.h"
 
 std::string app_id = "soft_renderer";
 int height = 300;
@@ -79,20 +80,81 @@ void render() {
 	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
 }
 
-int main()
+//null, file:<printf pattern> such as file:frame_%05d.png, or shm:<name> such as shm:/soft_renderer
+std::unique_ptr<Frame_sink> make_sink(const std::string& sink) {
+	if (sink == "null") return std::make_unique<Null_sink>();
+	if (sink.starts_with("file:")) return std::make_unique<File_sink>(sink.substr(5));
+	if (sink.starts_with("shm:")) return std::make_unique<Shared_memory_sink>(sink.substr(4), width, height);
+	throw std::invalid_argument("invalid sink " + sink);
+}
+
+//the whole of value as a number for option
+int parse_int(const std::string& option, const std::string& value) {
+	size_t end = 0;
+	int result = 0;
+	try { result = std::stoi(value, &end); } catch (const std::logic_error&) { end = 0; }
+	if (end == 0 || end != value.size()) throw std::invalid_argument("invalid value " + value + " for " + option);
+	return result;
+}
+
+// soft_renderer [--headless] [--frames n] [--sink null|file:<pattern>|shm:<name>] [--buffers 1|2|3]
+// with 2 or 3 buffers the next frame is rendered while the last one is presented on another thread
+int main(int argc, char** argv)
 {
+	TRACE_DUMP_AT_EXIT("trace.json");
+
+	bool headless = false;
+	int frames = 0;
+	std::string sink = "null";
+	int buffers = 2;
+	std::unique_ptr<Frame_sink> frame_sink{ nullptr };
+	try {
+		for (int i = 1; i < argc; i ++) {
+			std::string arg = argv[i];
+			if (arg == "--headless") headless = true;
+			else if (arg == "--frames" && i + 1 < argc) frames = parse_int(arg, argv[++ i]);
+			else if (arg == "--sink" && i + 1 < argc) sink = argv[++ i];
+			else if (arg == "--buffers" && i + 1 < argc) buffers = parse_int(arg, argv[++ i]);
+			else throw std::invalid_argument("invalid argument " + arg);
+		}
+		if (frames < 0) throw std::invalid_argument("invalid frame count " + std::to_string(frames));
+		if (buffers < 1 || buffers > 3) throw std::invalid_argument("invalid buffer count " + std::to_string(buffers));
+		if (headless) frame_sink = make_sink(sink);
+	} catch (const std::logic_error& error) {
+		std::cerr << "Error: " << error.what() << std::endl;
+		std::cerr << "usage: " << argv[0] << " [--headless] [--frames n] [--sink null|file:<pattern>|shm:<name>] [--buffers 1|2|3]" << std::endl;
+		return 1;
+	}
+
 	gpu->init(width, height);
-	app->init(width, height, app_id, gpu->color_buffer());
+	if (headless) app->init_headless(width, height, gpu->color_buffer(), std::move(frame_sink), frames);
+	else app->init(width, height, app_id, gpu->color_buffer());
 
 	load();
 
-	while (app->active) {
-		gpu->clear();
-
-		render();
-
-		app->update();
-		app->handle_message();
+	if (buffers == 1) {
+		while (app->active) {
+			gpu->clear();
+
+			render();
+
+			app->update();
+			app->handle_message();
+		}
+	} else {
+		Swap_chain swap_chain(width, height, buffers, [](const Frame_buffer& frame_buffer, int) {
+			app->present(reinterpret_cast<const u_int8_t*>(frame_buffer.color_buffer.get()));
+		});
+		while (app->active) {
+			gpu->set_frame_buffer(swap_chain.acquire());
+			app->set_canvas(gpu->color_buffer());
+			gpu->clear();
+
+			render();
+
+			swap_chain.swap();
+			app->handle_message();
+		}
 	}
 
 	app->exit();
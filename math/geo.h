@@ -89,6 +89,46 @@ namespace math {
 
 	};
 
+	//edge function f(p) = a * x + b * y + c, positive on the left side of u -> v
+	struct Edge2d {
+		decimal a{ 0.0 }, b{ 0.0 }, c{ 0.0 };
+
+		Edge2d() = default;
+		Edge2d(const Point2d& u, const Point2d& v) : a(u.y() - v.y()), b(v.x() - u.x()), c(u.x() * v.y() - u.y() * v.x()) {}
+
+		[[nodiscard]] decimal evaluate(decimal x, decimal y) const { return a * x + b * y + c; }
+		[[nodiscard]] decimal step(decimal dx, decimal dy) const { return a * dx + b * dy; }
+
+		//maximum over the rectangle [x0, x1] x [y0, y1]
+		[[nodiscard]] decimal max(decimal x0, decimal y0, decimal x1, decimal y1) const {
+			return a * (a > 0 ? x1 : x0) + b * (b > 0 ? y1 : y0) + c;
+		}
+
+		void flip() { a = -a, b = -b, c = -c; }
+	};
+
+	//edge function on fixed point coordinates, exact in 64 bit integers
+	struct Fixed_edge2d {
+		int64_t a{ 0 }, b{ 0 }, c{ 0 };
+
+		Fixed_edge2d() = default;
+		Fixed_edge2d(int64_t ux, int64_t uy, int64_t vx, int64_t vy) : a(uy - vy), b(vx - ux), c(ux * vy - uy * vx) {}
+
+		[[nodiscard]] int64_t evaluate(int64_t x, int64_t y) const { return a * x + b * y + c; }
+		[[nodiscard]] int64_t step(int64_t dx, int64_t dy) const { return a * dx + b * dy; }
+
+		//maximum over the rectangle [x0, x1] x [y0, y1]
+		[[nodiscard]] int64_t max(int64_t x0, int64_t y0, int64_t x1, int64_t y1) const {
+			return a * (a > 0 ? x1 : x0) + b * (b > 0 ? y1 : y0) + c;
+		}
+
+		//left edges and horizontal top edges of a triangle with positive area own the samples lying on them,
+		//so an edge shared by two triangles belongs to exactly one of them
+		[[nodiscard]] bool top_left() const { return a > 0 || (a == 0 && b < 0); }
+
+		void flip() { a = -a, b = -b, c = -c; }
+	};
+
 	struct Line2d {
 		Point2d a, b;
 
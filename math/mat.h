@@ -56,6 +56,14 @@ namespace math {
 
         Mat<T, S, V>() : data{} { }
         explicit Mat<T, S, V>(int value) { data.fill(value); }
+
+        //row major
+        template<typename Q>
+        explicit Mat<T, S, V>(const Q* mat, int size) {
+            for (int i = 0; i < std::min(size, S * V); i ++)
+                data[i] = mat[i];
+        }
+
         Mat<T, S, V>(const Mat<T, S, V>& mat) : data(mat.data) { }
         Mat<T, S, V>(Mat<T, S, V>&& mat) noexcept : data(std::move(mat.data)) { }
 
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "base.h"
+
+#if defined(SOFT_RENDERER_NO_SIMD)
+#define SOFT_RENDERER_SIMD_SCALAR
+#elif defined(__AVX__)
+#define SOFT_RENDERER_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define SOFT_RENDERER_SIMD_SSE2
+#include <emmintrin.h>
+#else
+#define SOFT_RENDERER_SIMD_SCALAR
+#endif
+
+namespace math {
+
+	//four decimal lanes, one AVX register, two SSE2 registers or plain scalars otherwise.
+	//float lanes fit one SSE register
+	struct Lane4 {
+		static constexpr int size = 4;
+
+#if defined(SOFT_RENDERER_FLOAT) && !defined(SOFT_RENDERER_SIMD_SCALAR)
+		__m128 v;
+
+		static Lane4 broadcast(decimal x) { return {_mm_set1_ps(x)}; }
+		static Lane4 set(decimal x0, decimal x1, decimal x2, decimal x3) { return {_mm_setr_ps(x0, x1, x2, x3)}; }
+
+		Lane4 operator+(const Lane4& rhs) const { return {_mm_add_ps(v, rhs.v)}; }
+		Lane4 operator-(const Lane4& rhs) const { return {_mm_sub_ps(v, rhs.v)}; }
+		Lane4 operator*(const Lane4& rhs) const { return {_mm_mul_ps(v, rhs.v)}; }
+		Lane4 operator/(const Lane4& rhs) const { return {_mm_div_ps(v, rhs.v)}; }
+
+		[[nodiscard]] int greater_mask(const Lane4& rhs) const { return _mm_movemask_ps(_mm_cmpgt_ps(v, rhs.v)); }
+
+		void store(decimal* out) const { _mm_storeu_ps(out, v); }
+#elif defined(SOFT_RENDERER_SIMD_AVX)
+		__m256d v;
+
+		static Lane4 broadcast(decimal x) { return {_mm256_set1_pd(x)}; }
+		static Lane4 set(decimal x0, decimal x1, decimal x2, decimal x3) { return {_mm256_setr_pd(x0, x1, x2, x3)}; }
+
+		Lane4 operator+(const Lane4& rhs) const { return {_mm256_add_pd(v, rhs.v)}; }
+		Lane4 operator-(const Lane4& rhs) const { return {_mm256_sub_pd(v, rhs.v)}; }
+		Lane4 operator*(const Lane4& rhs) const { return {_mm256_mul_pd(v, rhs.v)}; }
+		Lane4 operator/(const Lane4& rhs) const { return {_mm256_div_pd(v, rhs.v)}; }
+
+		//bit i is set when lane i is greater than rhs
+		[[nodiscard]] int greater_mask(const Lane4& rhs) const { return _mm256_movemask_pd(_mm256_cmp_pd(v, rhs.v, _CMP_GT_OQ)); }
+
+		void store(decimal* out) const { _mm256_storeu_pd(out, v); }
+#elif defined(SOFT_RENDERER_SIMD_SSE2)
+		__m128d lo, hi;
+
+		static Lane4 broadcast(decimal x) { return {_mm_set1_pd(x), _mm_set1_pd(x)}; }
+		static Lane4 set(decimal x0, decimal x1, decimal x2, decimal x3) { return {_mm_setr_pd(x0, x1), _mm_setr_pd(x2, x3)}; }
+
+		Lane4 operator+(const Lane4& rhs) const { return {_mm_add_pd(lo, rhs.lo), _mm_add_pd(hi, rhs.hi)}; }
+		Lane4 operator-(const Lane4& rhs) const { return {_mm_sub_pd(lo, rhs.lo), _mm_sub_pd(hi, rhs.hi)}; }
+		Lane4 operator*(const Lane4& rhs) const { return {_mm_mul_pd(lo, rhs.lo), _mm_mul_pd(hi, rhs.hi)}; }
+		Lane4 operator/(const Lane4& rhs) const { return {_mm_div_pd(lo, rhs.lo), _mm_div_pd(hi, rhs.hi)}; }
+
+		[[nodiscard]] int greater_mask(const Lane4& rhs) const {
+			return _mm_movemask_pd(_mm_cmpgt_pd(lo, rhs.lo)) | (_mm_movemask_pd(_mm_cmpgt_pd(hi, rhs.hi)) << 2);
+		}
+
+		void store(decimal* out) const { _mm_storeu_pd(out, lo), _mm_storeu_pd(out + 2, hi); }
+#else
+		std::array<decimal, 4> v;
+
+		static Lane4 broadcast(decimal x) { return {{x, x, x, x}}; }
+		static Lane4 set(decimal x0, decimal x1, decimal x2, decimal x3) { return {{x0, x1, x2, x3}}; }
+
+		Lane4 operator+(const Lane4& rhs) const { return {{v[0] + rhs.v[0], v[1] + rhs.v[1], v[2] + rhs.v[2], v[3] + rhs.v[3]}}; }
+		Lane4 operator-(const Lane4& rhs) const { return {{v[0] - rhs.v[0], v[1] - rhs.v[1], v[2] - rhs.v[2], v[3] - rhs.v[3]}}; }
+		Lane4 operator*(const Lane4& rhs) const { return {{v[0] * rhs.v[0], v[1] * rhs.v[1], v[2] * rhs.v[2], v[3] * rhs.v[3]}}; }
+		Lane4 operator/(const Lane4& rhs) const { return {{v[0] / rhs.v[0], v[1] / rhs.v[1], v[2] / rhs.v[2], v[3] / rhs.v[3]}}; }
+
+		[[nodiscard]] int greater_mask(const Lane4& rhs) const {
+			int mask = 0;
+			for (int i = 0; i < size; i ++)
+				if (v[i] > rhs.v[i]) mask |= 1 << i;
+			return mask;
+		}
+
+		void store(decimal* out) const { std::copy(v.begin(), v.end(), out); }
+#endif
+
+		//a * wa + b * wb + c * wc
+		static Lane4 weighed(decimal a, decimal b, decimal c, const Lane4& wa, const Lane4& wb, const Lane4& wc) {
+			return broadcast(a) * wa + broadcast(b) * wb + broadcast(c) * wc;
+		}
+	};
+
+}
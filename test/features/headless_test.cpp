@@ -0,0 +1,102 @@
+#include "base.h"
+#include "application.h"
+#include "gpu.h"
+#include "swap_chain.h"
+
+int width = 64, height = 48;
+
+//keeps a copy of every presented frame
+struct Capture_sink : public Frame_sink {
+	std::shared_ptr<std::vector<std::vector<u_int8_t>>> frames = std::make_shared<std::vector<std::vector<u_int8_t>>>();
+
+	void present(const u_int8_t* pixels, int width_, int height_, int frame) override {
+		assert(width_ == width && height_ == height && frame == (int)frames->size());
+		frames->emplace_back(pixels, pixels + width_ * height_ * 3);
+	}
+};
+
+void test_frame_limit() {
+	auto sink = std::make_unique<Capture_sink>();
+	auto frames = sink->frames;
+	app->init_headless(width, height, gpu->color_buffer(), std::move(sink), 3);
+
+	int rendered = 0;
+	while (app->active) {
+		gpu->clear();
+		gpu->color_buffer().get()[0] = (u_int8_t)(rendered ++ + 1);
+		app->update();
+		app->handle_message();
+	}
+	app->exit();
+
+	assert(rendered == 3 && frames->size() == 3);
+	for (int i = 0; i < 3; i ++) assert((*frames)[i][0] == i + 1);
+	std::cout << "test_frame_limit passed" << std::endl;
+}
+
+//frames still in flight when the limit is reached are not handed to the sink
+void test_swap_chain_frame_limit() {
+	auto sink = std::make_unique<Capture_sink>();
+	auto frames = sink->frames;
+	app->init_headless(width, height, gpu->color_buffer(), std::move(sink), 4);
+	{
+		Swap_chain swap_chain(width, height, 3, [](const Frame_buffer& frame_buffer, int) {
+			app->present(reinterpret_cast<const u_int8_t*>(frame_buffer.color_buffer.get()));
+		});
+		while (app->active) {
+			gpu->set_frame_buffer(swap_chain.acquire());
+			gpu->clear();
+			swap_chain.swap();
+			app->handle_message();
+		}
+	}
+	app->exit();
+
+	assert(frames->size() == 4);
+	std::cout << "test_swap_chain_frame_limit passed" << std::endl;
+}
+
+void test_shared_memory() {
+	std::string name = "/soft_renderer_headless_test";
+	Shared_memory_sink sink(name, width, height);
+	std::vector<u_int8_t> pixels(width * height * 3);
+	for (int i = 0; i < pixels.size(); i ++) pixels[i] = (u_int8_t)(i * 7);
+	sink.present(pixels.data(), width, height, 5);
+
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	assert(fd >= 0);
+	size_t size = sizeof(Shared_memory_sink::Header) + pixels.size();
+	auto memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	assert(memory != MAP_FAILED);
+
+	auto header = static_cast<const Shared_memory_sink::Header*>(memory);
+	assert(header->sequence.load() == 2);
+	assert(header->width == width && header->height == height && header->frame == 5);
+	assert(std::memcmp(header->pixels(), pixels.data(), pixels.size()) == 0);
+	munmap(memory, size);
+
+	bool thrown = false;
+	try {
+		sink.present(pixels.data(), width + 1, height, 6);
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_shared_memory passed" << std::endl;
+}
+
+void test_file_pattern() {
+	File_sink sink("out/frame_%05d.png");
+	assert(sink.path(42) == "out/frame_00042.png");
+	std::cout << "test_file_pattern passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	test_frame_limit();
+	test_swap_chain_frame_limit();
+	test_shared_memory();
+	test_file_pattern();
+	return 0;
+}
@@ -0,0 +1,82 @@
+#define SOFT_RENDERER_TRACE
+#include "base.h"
+#include "profiler.h"
+
+int count_events(const std::string& trace, const std::string& name) {
+	int count = 0;
+	auto pattern = "\"name\":\"" + name + "\"";
+	for (auto i = trace.find(pattern); i != std::string::npos; i = trace.find(pattern, i + 1)) count ++;
+	return count;
+}
+
+std::string dump() {
+	std::stringstream trace;
+	TRACE_DUMP(trace);
+	return trace.str();
+}
+
+void test_nested_scopes() {
+	{
+		TRACE_SCOPE("outer");
+		for (int i = 0; i < 3; i ++) {
+			TRACE_SCOPE("inner");
+		}
+	}
+	auto trace = dump();
+	assert(count_events(trace, "outer") == 1);
+	assert(count_events(trace, "inner") == 3);
+	assert(trace.front() == '[' && trace.find(']') != std::string::npos);
+	std::cout << "test_nested_scopes passed" << std::endl;
+}
+
+//threads recording at the same time get their own tracks, events of finished threads are kept
+void test_threads() {
+	std::vector<std::thread> threads;
+	std::latch running(4);
+	for (int t = 0; t < 4; t ++) {
+		threads.emplace_back([&]() {
+			for (int i = 0; i < 10; i ++) {
+				TRACE_SCOPE("worker");
+			}
+			running.arrive_and_wait();
+		});
+	}
+	for (auto &thread : threads) thread.join();
+
+	auto trace = dump();
+	assert(count_events(trace, "worker") == 40);
+	for (int tid = 1; tid <= 5; tid ++) assert(trace.find("\"tid\":" + std::to_string(tid) + ",") != std::string::npos);
+	std::cout << "test_threads passed" << std::endl;
+}
+
+//threads started one after another reuse the rings of finished threads
+void test_rings_recycled() {
+	int rings = Profiler::get_instance()->ring_count();
+	for (int t = 0; t < 8; t ++) {
+		std::thread([]() {
+			TRACE_SCOPE("recycled");
+		}).join();
+	}
+	assert(Profiler::get_instance()->ring_count() == rings);
+	assert(count_events(dump(), "recycled") == 8);
+	std::cout << "test_rings_recycled passed" << std::endl;
+}
+
+//a full ring keeps the newest events
+void test_ring_wraps() {
+	std::thread([]() {
+		for (int i = 0; i < Profiler::ring_capacity + 100; i ++) {
+			TRACE_SCOPE("wrapped");
+		}
+	}).join();
+	assert(count_events(dump(), "wrapped") == Profiler::ring_capacity);
+	std::cout << "test_ring_wraps passed" << std::endl;
+}
+
+int main() {
+	test_nested_scopes();
+	test_threads();
+	test_rings_recycled();
+	test_ring_wraps();
+	return 0;
+}
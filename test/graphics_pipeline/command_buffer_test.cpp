@@ -0,0 +1,112 @@
+#include "base.h"
+#include "gpu.h"
+#include "command_buffer.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 200, height = 150;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+struct Objects { int ebo, position_vbo, color_vbo, uv_vbo; };
+
+Objects generate_objects() {
+	Objects objects{gpu->generate(OBJECT::ELEMENT_BUFFER), gpu->generate(OBJECT::VERTEX_BUFFER), gpu->generate(OBJECT::VERTEX_BUFFER), gpu->generate(OBJECT::VERTEX_BUFFER)};
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({objects.position_vbo, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({objects.color_vbo, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({objects.uv_vbo, 2, 0, 2});
+	return objects;
+}
+
+//one object per recording thread, each uploads its buffers and draws with its own model matrix
+void record(Command_buffer& commands, const Objects& objects, decimal angle) {
+	commands.bind(OBJECT::ELEMENT_BUFFER, objects.ebo);
+	commands.set_buffer(OBJECT::ELEMENT_BUFFER, scene::indices, 6);
+	commands.bind(OBJECT::VERTEX_BUFFER, objects.position_vbo);
+	commands.set_buffer(OBJECT::VERTEX_BUFFER, scene::positions, 12);
+	commands.bind(OBJECT::VERTEX_BUFFER, objects.color_vbo);
+	commands.set_buffer(OBJECT::VERTEX_BUFFER, scene::colors, 16);
+	commands.bind(OBJECT::VERTEX_BUFFER, objects.uv_vbo);
+	commands.set_buffer(OBJECT::VERTEX_BUFFER, scene::uvs, 8);
+	commands.set_shader(Default_Shader({}, camera.get_view_matrix(), camera.get_projection_matrix()));
+	commands.update_shader<Default_Shader>([angle](Default_Shader& shader) { shader.model = math::rotate({0.0, 1.0, 0.0}, angle); });
+	commands.set_state([](GPU& target) { target.cull_type = CULL_TYPE::DISABLE; });
+	commands.draw_primitive(PRIMITIVE::TRIANGLE);
+}
+
+void test_matches_immediate_drawing() {
+	std::vector<decimal> angles{10.0, 60.0, 100.0, 150.0};
+	std::vector<Objects> objects;
+	for (int i = 0; i < angles.size(); i ++) objects.push_back(generate_objects());
+
+	//immediate
+	gpu->clear();
+	for (int i = 0; i < angles.size(); i ++) {
+		gpu->bind(OBJECT::ELEMENT_BUFFER, objects[i].ebo);
+		gpu->set_buffer(OBJECT::ELEMENT_BUFFER, scene::indices, 6);
+		gpu->bind(OBJECT::VERTEX_BUFFER, objects[i].position_vbo);
+		gpu->set_buffer(OBJECT::VERTEX_BUFFER, scene::positions, 12);
+		gpu->bind(OBJECT::VERTEX_BUFFER, objects[i].color_vbo);
+		gpu->set_buffer(OBJECT::VERTEX_BUFFER, scene::colors, 16);
+		gpu->bind(OBJECT::VERTEX_BUFFER, objects[i].uv_vbo);
+		gpu->set_buffer(OBJECT::VERTEX_BUFFER, scene::uvs, 8);
+		gpu->set_shader(Default_Shader(math::rotate({0.0, 1.0, 0.0}, angles[i]), camera.get_view_matrix(), camera.get_projection_matrix()));
+		gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+	}
+	auto expected = snapshot();
+
+	//recorded concurrently, submitted in order
+	std::vector<Command_buffer> command_buffers(angles.size());
+	std::vector<std::thread> threads;
+	for (int i = 0; i < angles.size(); i ++) threads.emplace_back(record, std::ref(command_buffers[i]), std::cref(objects[i]), angles[i]);
+	for (auto &thread : threads) thread.join();
+
+	Command_buffer frame;
+	frame.clear();
+	std::vector<std::reference_wrapper<const Command_buffer>> submission{frame};
+	for (auto &commands : command_buffers) submission.emplace_back(commands);
+	gpu->submit(submission);
+
+	assert(snapshot() == expected);
+	std::cout << "test_matches_immediate_drawing passed" << std::endl;
+}
+
+void test_recording_does_not_touch_gpu() {
+	auto objects = generate_objects();
+	gpu->clear();
+	auto before = snapshot();
+
+	Command_buffer commands;
+	record(commands, objects, 30.0);
+	assert(commands.size() == 12);
+	assert(snapshot() == before);
+
+	gpu->submit(commands);
+	assert(snapshot() != before);
+	std::cout << "test_recording_does_not_touch_gpu passed" << std::endl;
+}
+
+void test_update_shader_type_mismatch() {
+	struct Other_shader : public Default_Shader {};
+
+	Command_buffer commands;
+	commands.set_shader(Default_Shader{});
+	commands.update_shader<Other_shader>([](Other_shader&) {});
+
+	bool thrown = false;
+	try {
+		gpu->submit(commands);
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_update_shader_type_mismatch passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	test_matches_immediate_drawing();
+	test_recording_does_not_touch_gpu();
+	test_update_shader_type_mismatch();
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 200, height = 150;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+//a grid of quads packed in one vbo, every quad indexes its own 4 vertices from 0
+const int quads = 9;
+std::vector<decimal> positions, colors, uvs;
+std::vector<int> indices;
+std::vector<Draw_indirect_command> records;
+
+void build() {
+	for (int q = 0; q < quads; q ++) {
+		decimal x = q % 3 * 2.0 - 3.0, y = q / 3 * 2.0 - 3.0;
+		positions.insert(positions.end(), {x, y, 0.0, x + 1.5, y, 0.0, x + 1.5, y + 1.5, 0.0, x, y + 1.5, -1.0});
+		for (int v = 0; v < 4; v ++) {
+			colors.insert(colors.end(), {q / 9.0, v / 4.0, 1.0 - q / 9.0, 1.0});
+			uvs.insert(uvs.end(), {v % 2 * 1.0, v / 2 * 1.0});
+		}
+		int first = (int)indices.size();
+		indices.insert(indices.end(), {0, 1, 2, 0, 2, 3});
+		//every third quad is skipped, one is drawn as a single triangle
+		int count = q == 4 ? 3 : 6;
+		records.push_back({count, first, q * 4, q % 3 == 2 ? 0 : 1});
+	}
+}
+
+void setup() {
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions.data(), (int)positions.size());
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors.data(), (int)colors.size());
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs.data(), (int)uvs.size());
+	gpu->set_shader(Default_Shader(math::rotate({1.0, 0.0, 0.0}, 20.0), camera.get_view_matrix(), camera.get_projection_matrix()));
+}
+
+void test_matches_separate_draws() {
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER);
+	gpu->bind(OBJECT::ELEMENT_BUFFER, ebo);
+	gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices.data(), (int)indices.size());
+
+	int indirect_buffer = gpu->generate(OBJECT::DRAW_INDIRECT_BUFFER);
+	gpu->bind(OBJECT::DRAW_INDIRECT_BUFFER, indirect_buffer);
+	gpu->set_buffer(OBJECT::DRAW_INDIRECT_BUFFER, records.data(), (int)records.size() * Draw_indirect_command::size);
+
+	int single_ebo = gpu->generate(OBJECT::ELEMENT_BUFFER);
+
+	for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+		gpu->pipeline_mode = mode;
+
+		gpu->clear();
+		gpu->bind(OBJECT::ELEMENT_BUFFER, single_ebo);
+		for (auto &[count, first_index, base_vertex, instance_count] : records) {
+			if (!instance_count) continue;
+			std::vector<int> shifted;
+			for (int i = first_index; i < first_index + count; i ++) shifted.push_back(indices[i] + base_vertex);
+			gpu->set_buffer(OBJECT::ELEMENT_BUFFER, shifted.data(), (int)shifted.size());
+			gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+		}
+		auto expected = snapshot();
+		assert(std::count(expected.begin(), expected.end(), 0) != expected.size());
+
+		gpu->clear();
+		gpu->bind(OBJECT::ELEMENT_BUFFER, ebo);
+		gpu->multi_draw_indirect(PRIMITIVE::TRIANGLE, (int)records.size());
+		assert(snapshot() == expected);
+
+		//the same records split over two submissions
+		gpu->clear();
+		gpu->multi_draw_indirect(PRIMITIVE::TRIANGLE, 4);
+		gpu->multi_draw_indirect(PRIMITIVE::TRIANGLE, (int)records.size() - 4, 4);
+		assert(snapshot() == expected);
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	std::cout << "test_matches_separate_draws passed" << std::endl;
+}
+
+void test_invalid_records() {
+	bool thrown = false;
+	try {
+		gpu->multi_draw_indirect(PRIMITIVE::TRIANGLE, (int)records.size() + 1);
+	} catch (const std::out_of_range&) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	//index ranges past the ebo, including one whose end overflows, and vertex ids past the vbo
+	//are rejected before anything is drawn
+	gpu->clear();
+	auto before = snapshot();
+	for (int broken_field = 0; broken_field < 4; broken_field ++) {
+		auto broken = records;
+		auto& drawn = broken[quads - 2];
+		if (broken_field == 0) drawn.first_index = (int)indices.size();
+		if (broken_field == 1) drawn.first_index = INT_MAX - 2;
+		if (broken_field == 2) drawn.base_vertex = quads * 4 - 2;
+		if (broken_field == 3) drawn.base_vertex = INT_MAX - 1;
+		gpu->set_buffer(OBJECT::DRAW_INDIRECT_BUFFER, broken.data(), (int)broken.size() * Draw_indirect_command::size);
+		thrown = false;
+		try {
+			gpu->multi_draw_indirect(PRIMITIVE::TRIANGLE, (int)broken.size());
+		} catch (const std::out_of_range&) {
+			thrown = true;
+		}
+		assert(thrown);
+		assert(snapshot() == before);
+	}
+	std::cout << "test_invalid_records passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	build();
+	setup();
+	test_matches_separate_draws();
+	test_invalid_records();
+	return 0;
+}
@@ -0,0 +1,111 @@
+#include "base.h"
+#include "gpu.h"
+#include "draw_queue.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 160, height = 120;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+void test_key_order() {
+	auto near = Sort_key{false, 1, 0, 0, 2.0}.encode();
+	auto far = Sort_key{false, 1, 0, 0, 20.0}.encode();
+	auto other_shader = Sort_key{false, 2, 0, 0, 1.0}.encode();
+	auto blended_near = Sort_key{true, 0, 0, 0, 2.0}.encode();
+	auto blended_far = Sort_key{true, 3, 0, 0, 20.0}.encode();
+
+	assert(near < far);
+	assert(far < other_shader);
+	assert(other_shader < blended_far);
+	assert(blended_far < blended_near);
+
+	bool thrown = false;
+	try {
+		auto unused = Sort_key{false, 1 << Sort_key::shader_bits, 0, 0, 0.0}.encode();
+	} catch (const std::out_of_range&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_key_order passed" << std::endl;
+}
+
+void test_radix_sort_is_stable() {
+	std::mt19937_64 random(7);
+	std::vector<uint64_t> keys(5000);
+	for (auto &key : keys) key = random() % 64 << (random() % 58);
+
+	std::vector<int> order(keys.size()), expected(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::iota(expected.begin(), expected.end(), 0);
+
+	Draw_queue::radix_sort(keys, order);
+	std::stable_sort(expected.begin(), expected.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+	assert(order == expected);
+	std::cout << "test_radix_sort_is_stable passed" << std::endl;
+}
+
+//counts fragment shader calls across the copies made by set_shader
+struct Counting_shader : public Default_Shader {
+	std::shared_ptr<std::atomic<int>> fragments = std::make_shared<std::atomic<int>>(0);
+
+	using Default_Shader::Default_Shader;
+
+	Fragment_shader_data fragment_shader(const Vertex_shader_data& input) override {
+		(*fragments) ++;
+		return Default_Shader::fragment_shader(input);
+	}
+};
+
+decimal positions[] = { -2.0, -2.0, 0.0, 2.0, -2.0, 0.0, 2.0, 2.0, 0.0, -2.0, 2.0, 0.0 };
+decimal colors[] = { 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+decimal uvs[] = { 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0 };
+int indices[] = { 0, 1, 2, 0, 2, 3 };
+
+//quads queued far to near, sorted submission draws the nearest first and early depth test rejects the rest
+void test_sorted_submission_reduces_overdraw() {
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices, 6);
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions, 12);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors, 16);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs, 8);
+
+	Counting_shader shader;
+	Draw_queue queue;
+	for (int i = 0; i < 8; i ++) {
+		decimal z = 6.0 - i * 0.5;
+		Command_buffer commands;
+		Counting_shader placed(math::translate(i * 0.1, 0.0, z), camera.get_view_matrix(), camera.get_projection_matrix());
+		placed.fragments = shader.fragments;
+		commands.set_shader(placed);
+		commands.draw_primitive(PRIMITIVE::TRIANGLE);
+		queue.push({false, 0, 0, 0, z + 8.0}, std::move(commands));
+	}
+
+	gpu->sorted_submission = false;
+	gpu->clear();
+	gpu->submit(queue);
+	auto expected = snapshot();
+	int unsorted = *shader.fragments;
+
+	*shader.fragments = 0;
+	gpu->sorted_submission = true;
+	gpu->clear();
+	gpu->submit(queue);
+	int sorted = *shader.fragments;
+	gpu->sorted_submission = false;
+
+	assert(snapshot() == expected);
+	assert(sorted * 2 < unsorted);
+	std::cout << "test_sorted_submission_reduces_overdraw passed (" << unsorted << " -> " << sorted << " fragments)" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	test_key_order();
+	test_radix_sort_is_stable();
+	test_sorted_submission_reduces_overdraw();
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 160, height = 120;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+//shades whole batches without calling the scalar fragment shader, batch sizes are recorded
+//across the copies made by set_shader
+struct Batch_shader : public Default_Shader {
+	std::shared_ptr<std::mutex> mutex = std::make_shared<std::mutex>();
+	std::shared_ptr<std::vector<int>> batches = std::make_shared<std::vector<int>>();
+
+	using Default_Shader::Default_Shader;
+
+	Fragment_shader_data fragment_shader(const Vertex_shader_data& input) override {
+		assert(false);
+		return {};
+	}
+
+	void fragment_shader_batch(std::span<const Vertex_shader_data> input, std::span<Fragment_shader_data> output) override {
+		assert(input.size() == output.size());
+		for (size_t i = 0; i < input.size(); i ++) output[i] = Default_Shader::fragment_shader(input[i]);
+		std::lock_guard<std::mutex> lock(*mutex);
+		batches->push_back((int)input.size());
+	}
+};
+
+//the batched shader gives the frames of the scalar one, with far fewer calls than fragments
+void test_matches_scalar_shader() {
+	auto model = math::rotate({0.0, 1.0, 0.0}, 30.0);
+	for (auto primitive : {PRIMITIVE::TRIANGLE, PRIMITIVE::LINE, PRIMITIVE::POINT}) {
+		for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+			gpu->pipeline_mode = mode;
+			gpu->point_size = 5;
+
+			gpu->clear();
+			gpu->set_shader(Default_Shader(model, camera.get_view_matrix(), camera.get_projection_matrix()));
+			gpu->draw_primitive(primitive);
+			auto expected = snapshot();
+
+			Batch_shader shader(model, camera.get_view_matrix(), camera.get_projection_matrix());
+			gpu->clear();
+			gpu->set_shader(shader);
+			gpu->draw_primitive(primitive);
+			assert(snapshot() == expected);
+
+			int fragments = std::accumulate(shader.batches->begin(), shader.batches->end(), 0);
+			assert(fragments > 0);
+			if (primitive == PRIMITIVE::TRIANGLE) assert(shader.batches->size() * 8 < fragments);
+		}
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	gpu->point_size = 1;
+	std::cout << "test_matches_scalar_shader passed" << std::endl;
+}
+
+void test_invalid_batch_size() {
+	gpu->set_shader(Default_Shader({}, camera.get_view_matrix(), camera.get_projection_matrix()));
+	for (int size : {0, -1}) {
+		gpu->fragment_batch_size = size;
+		for (auto primitive : {PRIMITIVE::TRIANGLE, PRIMITIVE::LINE, PRIMITIVE::POINT}) {
+			bool thrown = false;
+			try {
+				gpu->draw_primitive(primitive);
+			} catch (const std::invalid_argument&) {
+				thrown = true;
+			}
+			assert(thrown);
+		}
+	}
+	gpu->fragment_batch_size = 256;
+	std::cout << "test_invalid_batch_size passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	scene::load();
+	test_matches_scalar_shader();
+	test_invalid_batch_size();
+	return 0;
+}
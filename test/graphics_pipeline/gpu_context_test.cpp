@@ -0,0 +1,65 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 160, height = 120;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+void load(GPU& context) {
+	context.init(width, height);
+	scene::load(context);
+}
+
+std::vector<u_int8_t> render(GPU& context, decimal angle, int frames) {
+	for (int i = 0; i < frames; i ++) {
+		context.clear();
+		context.set_shader(Default_Shader(math::rotate({0.0, 1.0, 0.0}, angle), camera.get_view_matrix(), camera.get_projection_matrix()));
+		context.draw_primitive(PRIMITIVE::TRIANGLE);
+	}
+	return snapshot(context);
+}
+
+//objects, state and frame buffers of two contexts do not interfere
+void test_independent_objects() {
+	GPU first, second;
+	load(first);
+	assert(second.generate(OBJECT::VERTEX_BUFFER) == 1);
+
+	first.cull_type = CULL_TYPE::FRONT;
+	assert(second.cull_type == CULL_TYPE::DISABLE);
+	assert(&first != gpu && &second != gpu);
+	std::cout << "test_independent_objects passed" << std::endl;
+}
+
+//contexts rendering different scenes on their own threads give the frames they give alone
+void test_concurrent_contexts() {
+	const int context_count = 4;
+	std::vector<std::unique_ptr<GPU>> contexts;
+	std::vector<std::vector<u_int8_t>> expected;
+	for (int i = 0; i < context_count; i ++) {
+		contexts.push_back(std::make_unique<GPU>());
+		contexts[i]->thread_count = 2;
+		contexts[i]->pipeline_mode = i % 2 ? PIPELINE_MODE::BINNED : PIPELINE_MODE::IMMEDIATE;
+		load(*contexts[i]);
+		expected.push_back(render(*contexts[i], i * 40.0, 1));
+	}
+
+	std::vector<std::vector<u_int8_t>> results(context_count);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < context_count; i ++) {
+		threads.emplace_back([&, i]() { results[i] = render(*contexts[i], i * 40.0, 5); });
+	}
+	for (auto &thread : threads) thread.join();
+
+	for (int i = 0; i < context_count; i ++) assert(results[i] == expected[i]);
+	assert(expected[0] != expected[1]);
+	std::cout << "test_concurrent_contexts passed" << std::endl;
+}
+
+int main() {
+	test_independent_objects();
+	test_concurrent_contexts();
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 200, height = 150;
+
+decimal positions[] = { -1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.5, 0.0, 0.0, 0.0, -0.7 };
+decimal colors[] = { 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+decimal uvs[] = { 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 1.0 };
+int indices[] = { 0, 1, 2, 0, 3, 2 };
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+const int instance_count = 12;
+int model_vbo = 0;
+
+math::Transform3d instance_model(int instance) {
+	return math::translate(instance % 4 * 1.5 - 2.25, instance / 4 * 1.6 - 1.8, instance * 0.1) * math::rotate({0.0, 1.0, 0.0}, instance * 25.0);
+}
+
+void setup() {
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices, 6);
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions, 12);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors, 16);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs, 8);
+
+	//one row major model matrix per instance
+	std::vector<decimal> models;
+	for (int i = 0; i < instance_count; i ++) {
+		auto model = instance_model(i);
+		for (int r = 0; r < 4; r ++)
+			for (int c = 0; c < 4; c ++) models.push_back(model.at(r, c));
+	}
+	model_vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, model_vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, models.data(), (int)models.size());
+	gpu->set_instance_array({model_vbo, 16, 0, 16});
+}
+
+void test_matches_separate_draws() {
+	for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+		gpu->pipeline_mode = mode;
+
+		gpu->clear();
+		for (int i = 0; i < instance_count; i ++) {
+			gpu->set_shader(Default_Shader(instance_model(i), camera.get_view_matrix(), camera.get_projection_matrix()));
+			gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+		}
+		auto expected = snapshot();
+
+		gpu->clear();
+		gpu->set_shader(Default_Shader({}, camera.get_view_matrix(), camera.get_projection_matrix()));
+		gpu->draw_primitive_instanced(PRIMITIVE::TRIANGLE, instance_count);
+		assert(snapshot() == expected);
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	std::cout << "test_matches_separate_draws passed" << std::endl;
+}
+
+//the instance matrices do not outlive the instanced draw, a later plain draw with the same
+//shader uses its own model matrix again
+void test_plain_draw_after_instanced() {
+	gpu->set_shader(Default_Shader(math::rotate({0.0, 1.0, 0.0}, 40.0), camera.get_view_matrix(), camera.get_projection_matrix()));
+	gpu->clear();
+	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+	auto expected = snapshot();
+
+	gpu->clear();
+	gpu->draw_primitive_instanced(PRIMITIVE::TRIANGLE, instance_count);
+	gpu->clear();
+	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+	assert(snapshot() == expected);
+	std::cout << "test_plain_draw_after_instanced passed" << std::endl;
+}
+
+//set_shader copies the shader, the copies share the record of bound instances
+struct Instance_id_shader : public Default_Shader {
+	std::shared_ptr<std::vector<int>> bound = std::make_shared<std::vector<int>>();
+
+	void bind_instance(int instance_id, const decimal* attributes, int size) override {
+		assert(attributes == nullptr && size == 0);
+		bound->push_back(instance_id);
+	}
+};
+
+void test_instance_ids() {
+	Instance_id_shader shader;
+	gpu->set_instance_array({});
+	gpu->set_shader(shader);
+	gpu->draw_primitive_instanced(PRIMITIVE::TRIANGLE, 5);
+	assert((*shader.bound == std::vector<int>{0, 1, 2, 3, 4}));
+
+	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+	assert(shader.bound->size() == 5);
+	std::cout << "test_instance_ids passed" << std::endl;
+}
+
+void test_stream_too_short() {
+	gpu->set_instance_array({model_vbo, 16, 0, 16});
+	bool thrown = false;
+	try {
+		gpu->draw_primitive_instanced(PRIMITIVE::TRIANGLE, instance_count + 1);
+	} catch (const std::out_of_range&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_stream_too_short passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	setup();
+	test_matches_separate_draws();
+	test_plain_draw_after_instanced();
+	test_instance_ids();
+	test_stream_too_short();
+	return 0;
+}
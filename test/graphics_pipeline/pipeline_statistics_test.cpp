@@ -0,0 +1,149 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+
+int width = 120, height = 90;
+
+//a square facing the camera
+decimal positions[] = { -0.5, -0.5, 0.0, 0.5, -0.5, 0.0, 0.5, 0.5, 0.0, -0.5, 0.5, 0.0 };
+decimal colors[] = { 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+decimal uvs[] = { 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0 };
+int indices[] = { 0, 1, 2, 0, 2, 3 };
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -2.0});
+
+//scale keeps the projected size of the quad, a scale of (2 + z) / 2 puts its corners on the pixels of the quad at 0
+Default_Shader flat_shader(decimal z, decimal scale = 1.0) {
+	return Default_Shader(math::translate(0.0, 0.0, z) * math::scale(scale, scale, 1.0), camera.get_view_matrix(), camera.get_projection_matrix());
+}
+
+void setup() {
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices, 6);
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions, 12);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors, 16);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs, 8);
+}
+
+int covered_pixels() {
+	auto buffer = gpu->color_buffer();
+	int covered = 0;
+	for (int i = 0; i < width * height * 3; i += 3) {
+		if (buffer.get()[i] || buffer.get()[i + 1] || buffer.get()[i + 2]) covered ++;
+	}
+	return covered;
+}
+
+Pipeline_statistics query(const std::function<void()>& draws) {
+	int id = gpu->generate(OBJECT::QUERY);
+	gpu->begin_query(id);
+	draws();
+	gpu->end_query();
+	return gpu->query_result(id);
+}
+
+void test_single_quad() {
+	for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+		gpu->pipeline_mode = mode;
+		gpu->clear();
+		gpu->set_shader(flat_shader(0.0));
+		auto statistics = query([]() { gpu->draw_primitive(PRIMITIVE::TRIANGLE); });
+
+		assert(statistics[STATISTIC::VERTICES_FETCHED] == 4);
+		assert(statistics[STATISTIC::VERTEX_SHADER_INVOCATIONS] == 4);
+		assert(statistics[STATISTIC::TRIANGLES_CULLED] == 0);
+		assert(statistics[STATISTIC::CLIPPING_INVOCATIONS] == 2);
+		assert(statistics[STATISTIC::CLIPPING_PRIMITIVES] == 2);
+		assert(statistics[STATISTIC::FRAGMENTS_RASTERIZED] == covered_pixels());
+		assert(statistics[STATISTIC::FRAGMENTS_SHADED] == covered_pixels());
+		assert(statistics[STATISTIC::DEPTH_TEST_FAILED] == 0);
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	std::cout << "test_single_quad passed" << std::endl;
+}
+
+//both triangles share a winding, one of the two cull types drops the whole quad
+void test_culled() {
+	gpu->clear();
+	gpu->set_shader(flat_shader(0.0));
+	std::vector<Pipeline_statistics> results;
+	for (auto cull_type : {CULL_TYPE::FRONT, CULL_TYPE::BACK}) {
+		gpu->cull_type = cull_type;
+		results.push_back(query([]() { gpu->draw_primitive(PRIMITIVE::TRIANGLE); }));
+	}
+	gpu->cull_type = CULL_TYPE::DISABLE;
+
+	if (results[0][STATISTIC::TRIANGLES_CULLED] == 0) std::swap(results[0], results[1]);
+	auto& culled = results[0];
+	auto& kept = results[1];
+	assert(culled[STATISTIC::TRIANGLES_CULLED] == 2);
+	assert(culled[STATISTIC::CLIPPING_INVOCATIONS] == 0);
+	assert(culled[STATISTIC::FRAGMENTS_RASTERIZED] == 0);
+	assert(kept[STATISTIC::TRIANGLES_CULLED] == 0);
+	assert(kept[STATISTIC::CLIPPING_INVOCATIONS] == 2);
+	std::cout << "test_culled passed" << std::endl;
+}
+
+//the far quad drawn behind the near one fails the depth test everywhere, with the early
+//depth test those fragments are never shaded. The corners of the far quad drawn as points
+//land on those of the near one
+void test_overdraw() {
+	for (auto primitive : {PRIMITIVE::TRIANGLE, PRIMITIVE::POINT})
+		for (bool early : {false, true}) {
+			gpu->early_depth_test_enabled = early;
+			gpu->clear();
+			gpu->set_shader(flat_shader(0.0));
+			gpu->draw_primitive(primitive);
+
+			gpu->set_shader(flat_shader(0.5, 1.25));
+			auto statistics = query([primitive]() { gpu->draw_primitive(primitive); });
+			auto rasterized = statistics[STATISTIC::FRAGMENTS_RASTERIZED];
+			assert(rasterized > 0);
+			assert(statistics[STATISTIC::DEPTH_TEST_FAILED] == rasterized);
+			assert(statistics[STATISTIC::FRAGMENTS_SHADED] == (early ? 0 : rasterized));
+		}
+	gpu->early_depth_test_enabled = true;
+	std::cout << "test_overdraw passed" << std::endl;
+}
+
+void test_query_bracketing() {
+	int id = gpu->generate(OBJECT::QUERY);
+	gpu->set_shader(flat_shader(0.0));
+	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+
+	//draws outside of the query are not counted
+	gpu->begin_query(id);
+	gpu->end_query();
+	assert(gpu->query_result(id)[STATISTIC::VERTICES_FETCHED] == 0);
+
+	bool thrown = false;
+	gpu->begin_query(id);
+	try {
+		gpu->begin_query(id);
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	gpu->end_query();
+
+	thrown = false;
+	try {
+		gpu->end_query();
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_query_bracketing passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	setup();
+	test_single_quad();
+	test_culled();
+	test_overdraw();
+	test_query_bracketing();
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "simd.h"
+
+int width = 120, height = 90;
+
+//a square facing the camera
+decimal positions[] = { -0.5, -0.5, 0.0, 0.5, -0.5, 0.0, 0.5, 0.5, 0.0, -0.5, 0.5, 0.0 };
+decimal colors[] = { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+decimal uvs[] = { 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0 };
+int indices[] = { 0, 1, 2, 0, 2, 3 };
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -2.0});
+
+//every fragment gets the same color
+struct Flat_shader : public Default_Shader {
+	math::Color color{};
+
+	Flat_shader(decimal z, math::Color color_) :
+		Default_Shader(math::translate(0.0, 0.0, z) * math::scale(8.0, 8.0, 1.0), camera.get_view_matrix(), camera.get_projection_matrix()),
+		color(color_) {}
+
+	Fragment_shader_data fragment_shader(const Vertex_shader_data& input) override {
+		auto output = Default_Shader::fragment_shader(input);
+		output.color = color;
+		return output;
+	}
+};
+
+void setup() {
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices, 6);
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions, 12);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors, 16);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs, 8);
+}
+
+//the lanes give what plain decimal arithmetic gives, whichever register type backs them
+void test_lanes() {
+	auto a = math::Lane4::set(1.5, -2.0, 0.25, 3.0), b = math::Lane4::set(0.5, 4.0, -0.75, 3.0);
+	decimal sum[4], quotient[4], weighed[4];
+	(a + b).store(sum);
+	(a / b).store(quotient);
+	math::Lane4::weighed(2.0, 3.0, 0.5, a, b, a).store(weighed);
+
+	decimal x[] = { 1.5, -2.0, 0.25, 3.0 }, y[] = { 0.5, 4.0, -0.75, 3.0 };
+	for (int i = 0; i < 4; i ++) {
+		assert(sum[i] == x[i] + y[i]);
+		assert(quotient[i] == x[i] / y[i]);
+		assert(equal(weighed[i], (decimal)2.0 * x[i] + (decimal)3.0 * y[i] + (decimal)0.5 * x[i]));
+	}
+	assert(a.greater_mask(b) == 0b0101);
+	std::cout << "test_lanes passed" << std::endl;
+}
+
+//two quads far from the camera and a tenth of a unit apart are still ordered by the depth
+//buffer, whichever is drawn first
+void test_close_depths() {
+	math::Color near_color(255, 0, 0), far_color(0, 0, 255);
+	for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+		gpu->pipeline_mode = mode;
+		for (bool near_first : {false, true}) {
+			gpu->clear();
+			for (bool near : {near_first, !near_first}) {
+				gpu->set_shader(Flat_shader(near ? 60.0 : 60.1, near ? near_color : far_color));
+				gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+			}
+			for (int y = height / 2 - 2; y <= height / 2 + 2; y ++)
+				for (int x = width / 2 - 2; x <= width / 2 + 2; x ++) {
+					auto color = gpu->get_frame_buffer()->color_at(x, y);
+					assert(color.r == 255 && color.b == 0);
+				}
+		}
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	std::cout << "test_close_depths passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	setup();
+	test_lanes();
+	test_close_depths();
+	return 0;
+}
@@ -0,0 +1,65 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 160, height = 120;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+//overrides the scalar fragment shader, the static path must call it instead of Default_Shader's
+struct Inverted_shader : public Default_Shader {
+	using Default_Shader::Default_Shader;
+
+	Fragment_shader_data fragment_shader(const Vertex_shader_data& input) override {
+		auto output = Default_Shader::fragment_shader(input);
+		output.color = math::Color(255 - output.color.r, 255 - output.color.g, 255 - output.color.b);
+		return output;
+	}
+};
+
+template<typename T>
+void check_matches_dynamic() {
+	T shader(math::rotate({0.0, 1.0, 0.0}, 30.0), camera.get_view_matrix(), camera.get_projection_matrix());
+	for (auto primitive : {PRIMITIVE::TRIANGLE, PRIMITIVE::LINE, PRIMITIVE::POINT}) {
+		for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED, PIPELINE_MODE::STREAMING}) {
+			gpu->pipeline_mode = mode;
+			gpu->set_shader(shader);
+
+			gpu->clear();
+			gpu->draw_primitive(primitive);
+			auto expected = snapshot();
+
+			gpu->clear();
+			gpu->draw_primitive<T>(primitive);
+			assert(snapshot() == expected);
+		}
+	}
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+}
+
+void test_matches_dynamic() {
+	check_matches_dynamic<Default_Shader>();
+	check_matches_dynamic<Inverted_shader>();
+	std::cout << "test_matches_dynamic passed" << std::endl;
+}
+
+void test_shader_type_mismatch() {
+	gpu->set_shader(Inverted_shader());
+	bool thrown = false;
+	try {
+		gpu->draw_primitive<Default_Shader>(PRIMITIVE::TRIANGLE);
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_shader_type_mismatch passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	scene::load();
+	test_matches_dynamic();
+	test_shader_type_mismatch();
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include "base.h"
+#include "gpu.h"
+#include "swap_chain.h"
+
+int width = 32, height = 24;
+
+//frames are presented in swap order with the content they had when swapped,
+//the back buffer is never the one being presented
+void test_order_and_ownership() {
+	for (int count : {2, 3}) {
+		std::mutex mutex;
+		std::vector<std::pair<int, int>> presented;
+		std::atomic<const Frame_buffer*> presenting{ nullptr };
+
+		{
+			Swap_chain swap_chain(width, height, count, [&](const Frame_buffer& frame_buffer, int frame) {
+				presenting = &frame_buffer;
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				std::lock_guard<std::mutex> lock(mutex);
+				presented.emplace_back(frame, frame_buffer.color_at(0, 0).b);
+				presenting = nullptr;
+			});
+
+			for (int frame = 0; frame < 20; frame ++) {
+				auto back = swap_chain.acquire();
+				assert(swap_chain.acquire() == back);
+				assert(presenting.load() != back.get());
+				back->clear();
+				back->color_at(0, 0).b = (u_int8_t)(frame + 1);
+				swap_chain.swap();
+			}
+		}
+
+		assert(presented.size() == 20);
+		for (int frame = 0; frame < 20; frame ++) assert(presented[frame] == std::make_pair(frame, frame + 1));
+	}
+	std::cout << "test_order_and_ownership passed" << std::endl;
+}
+
+//a gpu context renders into whatever buffer it is given
+void test_render_into_back_buffer() {
+	GPU context;
+	context.init(width, height);
+	auto initial = context.color_buffer();
+	std::vector<u_int8_t> last;
+	Swap_chain swap_chain(width, height, 2, [&](const Frame_buffer& frame_buffer, int) {
+		auto pixels = reinterpret_cast<const u_int8_t*>(frame_buffer.color_buffer.get());
+		last.assign(pixels, pixels + width * height * 3);
+	});
+
+	auto back = swap_chain.acquire();
+	context.set_frame_buffer(back);
+	context.clear();
+	context.set_pixel(3, 4, math::Color(10, 20, 30), false);
+	assert(back->color_at(3, 4).r == 10);
+	//color_buffer follows the current frame buffer and keeps the one it was taken from alive
+	assert(context.color_buffer().get() == reinterpret_cast<u_int8_t*>(back->color_buffer.get()));
+	assert(initial.get() != context.color_buffer().get() && initial.use_count() == 1);
+	initial.get()[0] = 1;
+	swap_chain.swap();
+	swap_chain.wait_idle();
+	assert(last[((height - 1 - 4) * width + 3) * 3 + 2] == 10);
+	std::cout << "test_render_into_back_buffer passed" << std::endl;
+}
+
+void test_present_exception() {
+	Swap_chain swap_chain(width, height, 2, [](const Frame_buffer&, int frame) {
+		if (frame == 1) throw std::runtime_error("present failed");
+	});
+	swap_chain.acquire();
+	swap_chain.swap();
+	swap_chain.acquire();
+	swap_chain.swap();
+
+	bool thrown = false;
+	try {
+		swap_chain.wait_idle();
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	thrown = false;
+	try {
+		swap_chain.swap();
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	assert(thrown);
+	std::cout << "test_present_exception passed" << std::endl;
+}
+
+int main() {
+	test_order_and_ownership();
+	test_render_into_back_buffer();
+	test_present_exception();
+	return 0;
+}
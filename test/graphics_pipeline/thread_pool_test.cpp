@@ -0,0 +1,52 @@
+#include "base.h"
+#include "thread_pool.h"
+
+void test_every_task_runs_once() {
+	Thread_pool pool(4);
+	assert(pool.size() == 4);
+
+	std::vector<int> runs(1000, 0);
+	pool.parallel_for((int)runs.size(), [&](int i, int worker) {
+		assert(worker >= 0 && worker < pool.size());
+		runs[i] ++;
+	});
+
+	for (int count : runs) assert(count == 1);
+	std::cout << "test_every_task_runs_once passed" << std::endl;
+}
+
+void test_reuse() {
+	Thread_pool pool(3);
+	for (int round = 0; round < 100; round ++) {
+		std::atomic<int> sum{ 0 };
+		pool.parallel_for(round, [&](int i, int) { sum += i; });
+		assert(sum == round * (round - 1) / 2);
+	}
+	std::cout << "test_reuse passed" << std::endl;
+}
+
+void test_exception() {
+	Thread_pool pool(4);
+	bool thrown = false;
+	try {
+		pool.parallel_for(64, [&](int i, int) {
+			if (i == 17) throw std::out_of_range("task failed");
+		});
+	} catch (const std::out_of_range&) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	//still usable afterwards
+	std::atomic<int> count{ 0 };
+	pool.parallel_for(10, [&](int, int) { count ++; });
+	assert(count == 10);
+	std::cout << "test_exception passed" << std::endl;
+}
+
+int main() {
+	test_every_task_runs_once();
+	test_reuse();
+	test_exception();
+	return 0;
+}
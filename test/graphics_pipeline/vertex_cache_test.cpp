@@ -0,0 +1,49 @@
+#include "base.h"
+#include "gpu.h"
+#include "vertex_cache.h"
+
+Vertex_shader_data make_vertex(decimal x) {
+	return {math::homo_point(x, 0.0, 0.0), {}, {}, 1.0};
+}
+
+void test_hit_and_miss() {
+	Vertex_cache cache(4);
+	assert(cache.find(0) == nullptr);
+
+	cache.insert(0, make_vertex(1.0));
+	cache.insert(7, make_vertex(2.0));
+
+	assert(cache.find(0) != nullptr && equal(cache.find(0)->position.x(), 1.0));
+	assert(cache.find(7) != nullptr && equal(cache.find(7)->position.x(), 2.0));
+	assert(cache.find(1) == nullptr);
+	std::cout << "test_hit_and_miss passed" << std::endl;
+}
+
+void test_fifo_eviction() {
+	Vertex_cache cache(2);
+	cache.insert(0, make_vertex(0.0));
+	cache.insert(1, make_vertex(1.0));
+	cache.insert(2, make_vertex(2.0));
+
+	assert(cache.find(0) == nullptr);
+	assert(cache.find(1) != nullptr);
+	assert(cache.find(2) != nullptr);
+	std::cout << "test_fifo_eviction passed" << std::endl;
+}
+
+void test_clear() {
+	Vertex_cache cache(2);
+	cache.insert(3, make_vertex(3.0));
+	cache.clear();
+	assert(cache.find(3) == nullptr);
+	std::cout << "test_clear passed" << std::endl;
+}
+
+int main() {
+	test_hit_and_miss();
+	test_fifo_eviction();
+	test_clear();
+
+	std::cout << "All tests passed!" << std::endl;
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../test_scene.h"
+
+int width = 160, height = 120;
+
+void test_round_trip() {
+	Vertex_streams streams;
+	streams.resize(2);
+	Vertex_shader_data data{{1.0, 2.0, 3.0, 4.0}, {0.1, 0.2, 0.3, 0.4}, {0.5, 0.6}, 0.25};
+	streams.set(1, data);
+	assert(streams.push_back(data) == 2 && streams.size() == 3);
+
+	auto result = streams[2];
+	assert(result.position == data.position && result.color == data.color && result.uv == data.uv);
+	assert(result.inv_w == data.inv_w && streams.w[1] == data.position.w() && streams.v[1] == data.uv.y());
+
+	streams.clear();
+	assert(streams.size() == 0 && streams.inv_w.empty());
+	std::cout << "test_round_trip passed" << std::endl;
+}
+
+//the staged pipeline keeps its vertices in streams, the streaming one does not. Both give the same
+//frame when triangles are culled, cross the near plane or leave the guard band
+void test_matches_streaming() {
+	int query = gpu->generate(OBJECT::QUERY);
+	int64_t most_clipped = 0;
+	for (auto eye : {math::Vector3d{0.0, 0.0, -8.0}, math::Vector3d{0.0, 1.0, -0.6}, math::Vector3d{-2.0, 2.0, -1.5}}) {
+		Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, eye);
+		for (auto cull : {CULL_TYPE::DISABLE, CULL_TYPE::BACK, CULL_TYPE::FRONT}) {
+			gpu->cull_type = cull;
+			gpu->set_shader(Default_Shader(math::rotate({0.0, 1.0, 0.0}, 30.0), camera.get_view_matrix(), camera.get_projection_matrix()));
+
+			gpu->pipeline_mode = PIPELINE_MODE::STREAMING;
+			gpu->clear();
+			gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+			auto expected = snapshot();
+
+			for (auto mode : {PIPELINE_MODE::IMMEDIATE, PIPELINE_MODE::BINNED}) {
+				gpu->pipeline_mode = mode;
+				gpu->clear();
+				gpu->begin_query(query);
+				gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+				gpu->end_query();
+				assert(snapshot() == expected);
+				most_clipped = std::max(most_clipped, gpu->query_result(query)[STATISTIC::CLIPPING_PRIMITIVES]);
+			}
+		}
+	}
+	assert(most_clipped > 2);
+	gpu->cull_type = CULL_TYPE::DISABLE;
+	gpu->pipeline_mode = PIPELINE_MODE::IMMEDIATE;
+	std::cout << "test_matches_streaming passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	scene::load();
+	test_round_trip();
+	test_matches_streaming();
+	return 0;
+}
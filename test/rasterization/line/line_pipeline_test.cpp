@@ -0,0 +1,110 @@
+#include "base.h"
+#include "gpu.h"
+#include "raster.h"
+#include "camera.h"
+
+int width = 160, height = 120;
+
+Vertex_shader_data make_vertex(decimal x, decimal y, decimal red) {
+	return {math::homo_point(x, y, 0.0), {red, 0.0, 0.0, 1.0}, {red, 0.0}, 1.0};
+}
+
+//every octant: one pixel per step of the major axis, 8-connected, last pixel left out, varyings linear
+void test_raster_octants() {
+	std::pair<math::Pixel, math::Pixel> bounds{{-100, -100}, {100, 100}};
+	for (auto [x, y] : std::vector<std::pair<int, int>>{{40, 13}, {13, 40}, {-13, 40}, {-40, 13}, {-40, -13}, {-13, -40}, {13, -40}, {40, -13}, {25, 25}, {0, 30}, {30, 0}}) {
+		std::vector<Vertex_shader_data> pixels;
+		Raster::line_shader_data(make_vertex(0.5, 0.5, 0.0), make_vertex(x + 0.5, y + 0.5, 1.0), bounds, [&](const Vertex_shader_data& fragment) {
+			pixels.push_back(fragment);
+		});
+
+		int steps = std::max(std::abs(x), std::abs(y));
+		assert(pixels.size() == steps);
+		assert(equal(pixels.front().position.x(), 0.0) && equal(pixels.front().position.y(), 0.0));
+		for (int i = 0; i < steps; i ++) {
+			if (i) {
+				assert(std::abs(pixels[i].position.x() - pixels[i - 1].position.x()) <= 1.0 + eps);
+				assert(std::abs(pixels[i].position.y() - pixels[i - 1].position.y()) <= 1.0 + eps);
+			}
+			assert(std::abs(pixels[i].color.x() - (decimal)i / steps) < eps);
+			assert(std::abs(pixels[i].uv.x() - (decimal)i / steps) < eps);
+		}
+	}
+	std::cout << "test_raster_octants passed" << std::endl;
+}
+
+void test_raster_bounds() {
+	std::vector<Vertex_shader_data> pixels;
+	Raster::line_shader_data(make_vertex(-20.5, 5.5, 0.0), make_vertex(40.5, 5.5, 1.0), {{0, 0}, {9, 9}}, [&](const Vertex_shader_data& fragment) {
+		pixels.push_back(fragment);
+	});
+	assert(pixels.size() == 10);
+	for (auto &pixel : pixels) assert(pixel.position.x() >= 0 && pixel.position.x() <= 9);
+	std::cout << "test_raster_bounds passed" << std::endl;
+}
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+//a line through a quad, partly in front and partly behind it, and a line crossing the near plane
+decimal positions[] = {
+	-2.0, -2.0, 0.0, 2.0, -2.0, 0.0, 2.0, 2.0, 0.0, -2.0, 2.0, 0.0,
+	-3.0, 0.0, -1.0, 3.0, 0.0, 1.0,
+	0.5, -1.0, 20.0, 0.5, 1.0, -20.0
+};
+decimal colors[32] = {};
+decimal uvs[16] = {};
+int quad[] = { 0, 1, 2, 0, 2, 3 };
+int lines[] = { 4, 5, 6, 7 };
+
+int count_color(u_int8_t b, u_int8_t g, u_int8_t r) {
+	auto buffer = gpu->color_buffer();
+	int count = 0;
+	for (int i = 0; i < width * height; i ++) {
+		auto p = buffer.get() + i * 3;
+		if (p[0] == b && p[1] == g && p[2] == r) count ++;
+	}
+	return count;
+}
+
+void test_depth_tested_lines() {
+	for (int i = 0; i < 4; i ++) colors[i * 4 + 1] = colors[i * 4 + 3] = 1.0;
+	for (int i = 4; i < 8; i ++) colors[i * 4] = colors[i * 4 + 3] = 1.0;
+
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions, 24);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors, 32);
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs, 16);
+	int quad_ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, quad_ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, quad, 6);
+	int line_ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, line_ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, lines, 2);
+	gpu->set_shader(Default_Shader(math::Transform3d::identity(), camera.get_view_matrix(), camera.get_projection_matrix()));
+
+	gpu->clear();
+	gpu->draw_primitive(PRIMITIVE::LINE);
+	int alone = count_color(0, 0, 255);
+	assert(alone > 0);
+
+	gpu->clear();
+	gpu->bind(OBJECT::ELEMENT_BUFFER, quad_ebo);
+	gpu->draw_primitive(PRIMITIVE::TRIANGLE);
+	gpu->bind(OBJECT::ELEMENT_BUFFER, line_ebo);
+	gpu->draw_primitive(PRIMITIVE::LINE);
+	int occluded = count_color(0, 0, 255);
+	assert(occluded > 0 && occluded < alone);
+
+	//the second line crosses the near plane and is clipped instead of wrapping around
+	gpu->set_buffer(OBJECT::ELEMENT_BUFFER, lines, 4);
+	gpu->clear();
+	gpu->draw_primitive(PRIMITIVE::LINE);
+	assert(count_color(0, 0, 255) > alone);
+	std::cout << "test_depth_tested_lines passed" << std::endl;
+}
+
+int main() {
+	test_raster_octants();
+	test_raster_bounds();
+	gpu->init(width, height);
+	test_depth_tested_lines();
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "base.h"
+#include "gpu.h"
+#include "camera.h"
+#include "../../test_scene.h"
+
+int width = 160, height = 120;
+
+Camera camera(70.0, (decimal)width / height, -0.5, -1000.0, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, -8.0});
+
+std::vector<decimal> positions, colors, uvs;
+std::vector<int> indices;
+
+//a noisy sphere shell, many points land on the same pixel at different depths
+void build(int count) {
+	std::mt19937 random(3);
+	std::uniform_real_distribution<decimal> unit(-1.0, 1.0);
+	for (int i = 0; i < count; i ++) {
+		decimal x = unit(random), y = unit(random), z = unit(random);
+		decimal length = std::sqrt(x * x + y * y + z * z) + 1e-9;
+		decimal radius = 2.5 + 0.3 * unit(random);
+		positions.insert(positions.end(), {x / length * radius, y / length * radius, z / length * radius});
+		colors.insert(colors.end(), {(x + 1.0) / 2.0, (y + 1.0) / 2.0, (z + 1.0) / 2.0, 1.0});
+		uvs.insert(uvs.end(), {0.0, 0.0});
+		indices.push_back(i);
+	}
+
+	int vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({1, 3, 0, 3});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({2, 4, 0, 4});
+	vao = gpu->generate(OBJECT::VERTEX_ARRAY); gpu->bind(OBJECT::VERTEX_ARRAY, vao); gpu->set_vertex_array({3, 2, 0, 2});
+	int vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions.data(), (int)positions.size());
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, colors.data(), (int)colors.size());
+	vbo = gpu->generate(OBJECT::VERTEX_BUFFER); gpu->bind(OBJECT::VERTEX_BUFFER, vbo); gpu->set_buffer(OBJECT::VERTEX_BUFFER, uvs.data(), (int)uvs.size());
+	int ebo = gpu->generate(OBJECT::ELEMENT_BUFFER); gpu->bind(OBJECT::ELEMENT_BUFFER, ebo); gpu->set_buffer(OBJECT::ELEMENT_BUFFER, indices.data(), (int)indices.size());
+	gpu->set_shader(Default_Shader(math::Transform3d::identity(), camera.get_view_matrix(), camera.get_projection_matrix()));
+}
+
+int covered(const std::vector<u_int8_t>& image) {
+	int count = 0;
+	for (int i = 0; i < width * height; i ++) count += image[i * 3] || image[i * 3 + 1] || image[i * 3 + 2];
+	return count;
+}
+
+//declaring a depth write keeps points on the general path
+struct Depth_writing_shader : public Default_Shader {
+	using Default_Shader::Default_Shader;
+	[[nodiscard]] bool writes_depth() const override { return true; }
+};
+
+//the depth only pass shades one point per pixel but must give the same image
+void test_depth_only_pass_matches() {
+	gpu->blend_enabled = false;
+	gpu->point_size = 1;
+
+	gpu->set_shader(Depth_writing_shader(math::Transform3d::identity(), camera.get_view_matrix(), camera.get_projection_matrix()));
+	gpu->clear();
+	gpu->draw_primitive(PRIMITIVE::POINT);
+	auto expected = snapshot();
+	assert(covered(expected) > 1000);
+
+	gpu->set_shader(Default_Shader(math::Transform3d::identity(), camera.get_view_matrix(), camera.get_projection_matrix()));
+	for (int threads : {1, 4}) {
+		gpu->thread_count = threads;
+		gpu->clear();
+		gpu->draw_primitive(PRIMITIVE::POINT);
+		assert(snapshot() == expected);
+	}
+	gpu->blend_enabled = true;
+	std::cout << "test_depth_only_pass_matches passed" << std::endl;
+}
+
+void test_point_size() {
+	gpu->clear();
+	gpu->point_size = 1;
+	gpu->draw_primitive(PRIMITIVE::POINT);
+	int small = covered(snapshot());
+
+	gpu->clear();
+	gpu->point_size = 3;
+	gpu->draw_primitive(PRIMITIVE::POINT);
+	int large = covered(snapshot());
+	gpu->point_size = 1;
+
+	assert(large > small);
+	std::cout << "test_point_size passed" << std::endl;
+}
+
+//a single point of size 3 covers exactly 9 pixels, also across a tile corner
+void test_single_splat() {
+	decimal position[] = {0.0, 0.0, 0.0};
+	std::vector<decimal> saved = positions;
+	positions.assign(position, position + 3);
+	gpu->bind(OBJECT::VERTEX_BUFFER, 1);
+	gpu->set_buffer(OBJECT::VERTEX_BUFFER, positions.data(), 3);
+	int index = 0;
+	gpu->set_buffer(OBJECT::ELEMENT_BUFFER, &index, 1);
+
+	for (int tile_size : {64, 8}) {
+		gpu->tile_size = tile_size;
+		gpu->clear();
+		gpu->point_size = 3;
+		gpu->draw_primitive(PRIMITIVE::POINT);
+		assert(covered(snapshot()) == 9);
+	}
+	gpu->tile_size = 64;
+	gpu->point_size = 1;
+	std::cout << "test_single_splat passed" << std::endl;
+}
+
+int main() {
+	gpu->init(width, height);
+	build(200000);
+	test_depth_only_pass_matches();
+	test_point_size();
+	test_single_splat();
+	return 0;
+}
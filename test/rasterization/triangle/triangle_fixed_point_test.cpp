@@ -0,0 +1,61 @@
+#include "base.h"
+#include "gpu.h"
+#include "raster.h"
+
+const int size = 64;
+
+Vertex_shader_data make_vertex(decimal x, decimal y) {
+	return {math::homo_point(x, y, 0.0), {1.0, 1.0, 1.0, 1.0}, {}, 1.0};
+}
+
+std::vector<int> coverage(const std::vector<std::array<Vertex_shader_data, 3>>& triangles) {
+	std::vector<int> count(size * size, 0);
+	std::pair<math::Pixel, math::Pixel> bounds{{0, 0}, {size - 1, size - 1}};
+	for (auto &[a, b, c] : triangles) {
+		Raster::triangle_shader_data_fixed(a, b, c, 1, bounds, [&](const Vertex_shader_data& fragment) {
+			count[(int)fragment.position.y() * size + (int)fragment.position.x()] ++;
+		});
+	}
+	return count;
+}
+
+//a fan around an off-grid center, every pixel center of the square is covered exactly once
+void test_fan_is_watertight() {
+	auto center = make_vertex(31.37, 29.81);
+	std::vector<Vertex_shader_data> ring{
+		make_vertex(0.0, 0.0), make_vertex(17.25, 0.0), make_vertex(size, 0.0), make_vertex(size, 40.5),
+		make_vertex(size, size), make_vertex(8.125, size), make_vertex(0.0, size), make_vertex(0.0, 12.0)
+	};
+
+	std::vector<std::array<Vertex_shader_data, 3>> triangles;
+	for (int i = 0; i < ring.size(); i ++) triangles.push_back({center, ring[i], ring[(i + 1) % ring.size()]});
+
+	auto count = coverage(triangles);
+	for (int i = 0; i < size * size; i ++) assert(count[i] == 1);
+	std::cout << "test_fan_is_watertight passed" << std::endl;
+}
+
+//pixel centers lying exactly on a shared diagonal belong to one of the two triangles
+void test_shared_edge_through_centers() {
+	auto a = make_vertex(0.0, 0.0), b = make_vertex(size, 0.0), c = make_vertex(size, size), d = make_vertex(0.0, size);
+	auto count = coverage({{a, b, c}, {a, c, d}});
+	for (int i = 0; i < size * size; i ++) assert(count[i] == 1);
+
+	//winding does not change ownership
+	count = coverage({{a, c, b}, {a, d, c}});
+	for (int i = 0; i < size * size; i ++) assert(count[i] == 1);
+	std::cout << "test_shared_edge_through_centers passed" << std::endl;
+}
+
+void test_degenerate() {
+	auto count = coverage({{make_vertex(1.0, 1.0), make_vertex(20.0, 20.0), make_vertex(40.0, 40.0)}});
+	for (int i = 0; i < size * size; i ++) assert(count[i] == 0);
+	std::cout << "test_degenerate passed" << std::endl;
+}
+
+int main() {
+	test_fan_is_watertight();
+	test_shared_edge_through_centers();
+	test_degenerate();
+	return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "base.h"
+#include "gpu.h"
+
+namespace scene {
+
+//two triangles sharing an edge, the second one leans away from the camera
+inline decimal positions[] = { -3.0, 0.0, 0.0, 3.0, 0.0, 0.0, 0.0, 5.0, 0.0, 0.0, 0.0, -2.0 };
+inline decimal colors[] = { 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+inline decimal uvs[] = { 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 1.0 };
+inline int indices[] = { 0, 1, 2, 0, 3, 2 };
+
+//uploads the scene into a fresh context, its position, color and uv vbos are 1, 2 and 3
+inline void load(GPU& context = *gpu) {
+	int ebo = context.generate(OBJECT::ELEMENT_BUFFER); context.bind(OBJECT::ELEMENT_BUFFER, ebo); context.set_buffer(OBJECT::ELEMENT_BUFFER, indices, 6);
+	int vao = context.generate(OBJECT::VERTEX_ARRAY); context.bind(OBJECT::VERTEX_ARRAY, vao); context.set_vertex_array({1, 3, 0, 3});
+	vao = context.generate(OBJECT::VERTEX_ARRAY); context.bind(OBJECT::VERTEX_ARRAY, vao); context.set_vertex_array({2, 4, 0, 4});
+	vao = context.generate(OBJECT::VERTEX_ARRAY); context.bind(OBJECT::VERTEX_ARRAY, vao); context.set_vertex_array({3, 2, 0, 2});
+	int vbo = context.generate(OBJECT::VERTEX_BUFFER); context.bind(OBJECT::VERTEX_BUFFER, vbo); context.set_buffer(OBJECT::VERTEX_BUFFER, positions, 12);
+	vbo = context.generate(OBJECT::VERTEX_BUFFER); context.bind(OBJECT::VERTEX_BUFFER, vbo); context.set_buffer(OBJECT::VERTEX_BUFFER, colors, 16);
+	vbo = context.generate(OBJECT::VERTEX_BUFFER); context.bind(OBJECT::VERTEX_BUFFER, vbo); context.set_buffer(OBJECT::VERTEX_BUFFER, uvs, 8);
+}
+
+}
+
+//a copy of the color buffer the context currently renders into
+inline std::vector<u_int8_t> snapshot(GPU& context = *gpu) {
+	auto buffer = context.color_buffer();
+	auto& frame_buffer = *context.get_frame_buffer();
+	return {buffer.get(), buffer.get() + frame_buffer.width * frame_buffer.height * 3};
+}